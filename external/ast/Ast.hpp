@@ -39,6 +39,10 @@ namespace ast {
         JSONValue(const JSONObject& obj) : value(obj) {}
     };
 
+    inline bool operator==(const JSONValue& lhs, const JSONValue& rhs) {
+        return lhs.value == rhs.value;
+    }
+
     // Recursive serialization for JSONValue
     inline void to_json_value(const JSONValue& jv, Value& out, Document::AllocatorType& alloc) {
         std::visit([&](auto&& arg) {
@@ -68,6 +72,48 @@ namespace ast {
         }, jv.value);
     }
 
+    // SAX traversal for JSONValue: emits events to any rapidjson-compatible handler
+    // (Writer, Document, hashers) without building an intermediate DOM
+    template <typename Handler>
+    bool accept(const JSONValue& jv, Handler& handler);
+
+    template <typename Handler>
+    bool accept(const JSONArray& arr, Handler& handler) {
+        if (!handler.StartArray())
+            return false;
+        for (const auto& el : arr) {
+            if (!accept(el, handler))
+                return false;
+        }
+        return handler.EndArray(static_cast<SizeType>(arr.size()));
+    }
+
+    template <typename Handler>
+    bool accept(const JSONObject& obj, Handler& handler) {
+        if (!handler.StartObject())
+            return false;
+        for (const auto& [k, v] : obj) {
+            if (!handler.Key(k.c_str(), static_cast<SizeType>(k.size()), true) || !accept(v, handler))
+                return false;
+        }
+        return handler.EndObject(static_cast<SizeType>(obj.size()));
+    }
+
+    template <typename Handler>
+    bool accept(const JSONValue& jv, Handler& handler) {
+        return std::visit([&](auto&& arg) -> bool {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, std::string>)
+                return handler.String(arg.c_str(), static_cast<SizeType>(arg.size()), true);
+            else if constexpr (std::is_same_v<T, double>)
+                return handler.Double(arg);
+            else if constexpr (std::is_same_v<T, bool>)
+                return handler.Bool(arg);
+            else
+                return accept(arg, handler);
+        }, jv.value);
+    }
+
     // ====================== Node AST ======================
 
     struct Node {
@@ -213,6 +259,37 @@ namespace ast {
         }
     }
 
+    // SAX traversal for Node, same layout as to_json
+    template <typename Handler>
+    bool accept(const Node& node, Handler& handler) {
+        SizeType members = 1;
+        if (!handler.StartObject())
+            return false;
+        if (!handler.Key("type", 4, false) ||
+            !handler.String(node.type.c_str(), static_cast<SizeType>(node.type.size()), true))
+            return false;
+
+        if (!node.props.empty()) {
+            ++members;
+            if (!handler.Key("props", 5, false) || !accept(node.props, handler))
+                return false;
+        }
+
+        if (!node.children.empty()) {
+            ++members;
+            if (!handler.Key("children", 8, false) || !handler.StartArray())
+                return false;
+            for (const auto& c : node.children) {
+                if (!accept(c, handler))
+                    return false;
+            }
+            if (!handler.EndArray(static_cast<SizeType>(node.children.size())))
+                return false;
+        }
+
+        return handler.EndObject(members);
+    }
+
     // ---------- stringify ----------
 
     inline std::string stringify(const Node& node) {
@@ -226,6 +303,15 @@ namespace ast {
         return buffer.GetString();
     }
 
+    inline std::string stringify(const JSONValue& value) {
+        Document doc;
+        to_json_value(value, doc, doc.GetAllocator());
+        StringBuffer buffer;
+        Writer<StringBuffer> writer(buffer);
+        doc.Accept(writer);
+        return buffer.GetString();
+    }
+
     // ---------- none helper ----------
 
     inline std::vector<Node> none() { return {}; }
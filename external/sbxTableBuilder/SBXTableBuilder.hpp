@@ -4,6 +4,7 @@
 #include <vector>
 #include <utility>
 #include <optional>
+#include <unordered_map>
 #include "ast/Ast.hpp"
 
 using namespace ast;
@@ -117,6 +118,10 @@ public:
         _rows.push_back(std::move(json_row));
     }
 
+    void AddRow(JSONArray&& row_values) { _rows.push_back(std::move(row_values)); }
+
+    void SetName(const std::string& table_name) { _table_name = table_name; }
+
     void SetIdColumn(const std::string& id_column) { _id_column = id_column; }
 
     void SetOrderBy(const std::string& column, const std::string& order = "DESC") {
@@ -137,7 +142,209 @@ public:
 
     void SetTotalData(const JSONArray& total_data) { _total_data = total_data; }
 
+    // Компактная кодировка data.rows: константные колонки выносятся в заголовок,
+    // повторяющиеся строки заменяются индексами словаря
+    void EnableCompactRows(const bool& enabled) { _is_compact_rows_enabled = enabled; }
+
+    // Сброс состояния для повторного использования builder'а, емкость буферов сохраняется
+    void Clear() {
+        _id_column.clear();
+        _column_order_by_keys.clear();
+        _rows.clear();
+        _structure.clear();
+        _order_by = {"id", "DESC"};
+        _is_auto_save_enabled = false;
+        _is_refresh_button_enabled = true;
+        _is_bookmarks_button_enabled = true;
+        _is_export_button_enabled = true;
+        _is_total_row_enabled = false;
+        _total_data_title.clear();
+        _total_data.clear();
+        _is_compact_rows_enabled = false;
+        _encoded_rows.reset();
+    }
+
+    // Емкость буфера строк, сохраняемая между Clear()
+    [[nodiscard]] size_t RowCapacity() const { return _rows.capacity(); }
+
+    // Освобождение сохраненной емкости буферов
+    void ShrinkToFit() {
+        _column_order_by_keys.shrink_to_fit();
+        _rows.shrink_to_fit();
+        _total_data.shrink_to_fit();
+    }
+
+    // Заменяет data.rows закодированным представлением (например, сжатым blob'ом)
+    void SetEncodedRows(const std::string& codec, std::string blob) {
+        _encoded_rows = std::make_pair(codec, std::move(blob));
+    }
+
     [[nodiscard]] JSONObject CreateTableProps() const {
+        JSONObject table_props = CreateTablePropsHeader();
+        table_props["data"] = CreateData();
+
+        return table_props;
+    }
+
+    // SAX-обход таблицы: те же данные, что и CreateTableProps(), без построения промежуточного JSONObject
+    template <typename Handler>
+    bool Accept(Handler& handler) const {
+        JSONObject table_props = CreateTablePropsHeader();
+        table_props["data"] = JSONValue();
+
+        if (!handler.StartObject()) return false;
+
+        for (const auto& [key, value] : table_props) {
+            if (!handler.Key(key.c_str(), static_cast<SizeType>(key.size()), true)) return false;
+
+            const bool is_accepted = key == "data" ? AcceptData(handler) : ast::accept(value, handler);
+            if (!is_accepted) return false;
+        }
+
+        return handler.EndObject(static_cast<SizeType>(table_props.size()));
+    }
+
+    // SAX-обход массива data.rows в текущей кодировке
+    template <typename Handler>
+    bool AcceptRows(Handler& handler) const {
+        if (_is_compact_rows_enabled) {
+            return ast::accept(CreateCompactData().at("rows"), handler);
+        }
+
+        if (!handler.StartArray()) return false;
+
+        for (const auto& row : _rows) {
+            if (!ast::accept(row, handler)) return false;
+        }
+
+        return handler.EndArray(static_cast<SizeType>(_rows.size()));
+    }
+
+private:
+    std::string _table_name;
+    std::string _id_column;
+    std::vector<std::string> _column_order_by_keys;
+    std::vector<JSONArray> _rows;
+    JSONObject _structure;
+    std::pair<std::string, std::string> _order_by{"id", "DESC"};
+    bool _is_auto_save_enabled = false;
+    bool _is_refresh_button_enabled = true;
+    bool _is_bookmarks_button_enabled = true;
+    bool _is_export_button_enabled = true;
+    bool _is_total_row_enabled = false;
+    std::string _total_data_title;
+    JSONArray _total_data;
+    bool _is_compact_rows_enabled = false;
+    std::optional<std::pair<std::string, std::string>> _encoded_rows;
+
+    // Способ кодирования колонки в компактном режиме
+    enum class ColumnEncoding {
+        Plain,               // Значение передается как есть
+        Constant,            // Одно значение на все строки, передается в data.constants
+        Dictionary           // Индекс в data.dictionaries[key]
+    };
+
+    [[nodiscard]] JSONObject CreateCompactData() const {
+        const size_t columns_count = _column_order_by_keys.size();
+        std::vector<ColumnEncoding> encodings(columns_count, ColumnEncoding::Plain);
+        std::vector<std::unordered_map<std::string, double>> dictionary_indexes(columns_count);
+        std::vector<JSONArray> dictionaries(columns_count);
+
+        for (size_t column = 0; column < columns_count && !_rows.empty(); ++column) {
+            bool is_constant = true;
+            bool is_string = true;
+
+            for (const auto& row : _rows) {
+                if (column >= row.size()) {
+                    is_constant = false;
+                    is_string = false;
+                    break;
+                }
+                is_constant = is_constant && row[column] == _rows.front()[column];
+                is_string = is_string && std::holds_alternative<std::string>(row[column].value);
+            }
+
+            if (is_constant) {
+                encodings[column] = ColumnEncoding::Constant;
+                continue;
+            }
+
+            if (!is_string) {
+                continue;
+            }
+
+            for (const auto& row : _rows) {
+                const auto& str = std::get<std::string>(row[column].value);
+                if (dictionary_indexes[column].emplace(str, dictionaries[column].size()).second) {
+                    dictionaries[column].emplace_back(str);
+                }
+            }
+
+            // Словарь выгоден только при заметном количестве повторов
+            if (dictionaries[column].size() * 2 <= _rows.size()) {
+                encodings[column] = ColumnEncoding::Dictionary;
+            } else {
+                dictionary_indexes[column].clear();
+                dictionaries[column].clear();
+            }
+        }
+
+        JSONObject constants;
+        JSONObject dictionaries_obj;
+        JSONArray structure_keys;
+        JSONArray column_keys;
+        column_keys.reserve(columns_count);
+
+        for (size_t column = 0; column < columns_count; ++column) {
+            const auto& key = _column_order_by_keys[column];
+            column_keys.emplace_back(key);
+
+            switch (encodings[column]) {
+                case ColumnEncoding::Constant: constants[key] = _rows.front()[column]; break;
+                case ColumnEncoding::Dictionary:
+                    dictionaries_obj[key] = std::move(dictionaries[column]);
+                    structure_keys.emplace_back(key);
+                    break;
+                case ColumnEncoding::Plain: structure_keys.emplace_back(key); break;
+            }
+        }
+
+        JSONArray json_rows;
+        json_rows.reserve(_rows.size());
+
+        for (const auto& row : _rows) {
+            JSONArray json_row;
+            json_row.reserve(structure_keys.size());
+
+            for (size_t column = 0; column < row.size(); ++column) {
+                const ColumnEncoding encoding = column < columns_count ? encodings[column] : ColumnEncoding::Plain;
+
+                if (encoding == ColumnEncoding::Constant) {
+                    continue;
+                }
+
+                if (encoding == ColumnEncoding::Dictionary) {
+                    json_row.emplace_back(dictionary_indexes[column].at(std::get<std::string>(row[column].value)));
+                } else {
+                    json_row.push_back(row[column]);
+                }
+            }
+
+            json_rows.emplace_back(std::move(json_row));
+        }
+
+        JSONObject data_obj;
+        data_obj["encoding"] = "compact";
+        data_obj["columns"] = std::move(column_keys);
+        data_obj["structure"] = std::move(structure_keys);
+        data_obj["constants"] = std::move(constants);
+        data_obj["dictionaries"] = std::move(dictionaries_obj);
+        data_obj["rows"] = std::move(json_rows);
+
+        return data_obj;
+    }
+
+    [[nodiscard]] JSONObject CreateTablePropsHeader() const {
         JSONObject table_props;
         table_props["name"] = _table_name;
         table_props["idCol"] = _id_column;
@@ -153,17 +360,61 @@ public:
             table_props["totalData"] = _total_data;
         }
 
+        table_props["structure"] = _structure;
+
+        return table_props;
+    }
+
+    [[nodiscard]] JSONObject CreateData() const {
         JSONObject data_obj;
-        JSONArray json_rows;
-        json_rows.reserve(_rows.size());
 
-        for (const auto& row : _rows) {
-            json_rows.emplace_back(row);
+        if (_is_compact_rows_enabled) {
+            data_obj = CreateCompactData();
+        } else {
+            JSONArray json_rows;
+            json_rows.reserve(_rows.size());
+
+            for (const auto& row : _rows) {
+                json_rows.emplace_back(row);
+            }
+
+            data_obj["rows"] = std::move(json_rows);
+            data_obj["structure"] = CreateStructureKeys();
         }
 
-        data_obj["rows"] = std::move(json_rows);
+        if (_encoded_rows) {
+            data_obj.erase("rows");
+            data_obj["rowsCodec"] = _encoded_rows->first;
+            data_obj["rowsBlob"] = _encoded_rows->second;
+        }
 
+        return data_obj;
+    }
+
+    template <typename Handler>
+    bool AcceptData(Handler& handler) const {
+        // Компактной кодировке нужна статистика по колонкам, поэтому она собирается целиком
+        if (_is_compact_rows_enabled) {
+            return ast::accept(CreateData(), handler);
+        }
+
+        if (!handler.StartObject()) return false;
+
+        if (_encoded_rows) {
+            if (!handler.Key("rowsBlob", 8, false)) return false;
+            if (!handler.String(_encoded_rows->second.c_str(), static_cast<SizeType>(_encoded_rows->second.size()), true)) return false;
+            if (!handler.Key("rowsCodec", 9, false)) return false;
+            if (!handler.String(_encoded_rows->first.c_str(), static_cast<SizeType>(_encoded_rows->first.size()), true)) return false;
+        } else {
+            if (!handler.Key("rows", 4, false) || !AcceptRows(handler)) return false;
+        }
+
+        if (!handler.Key("structure", 9, false) || !ast::accept(CreateStructureKeys(), handler)) return false;
 
+        return handler.EndObject(_encoded_rows ? 3 : 2);
+    }
+
+    [[nodiscard]] JSONArray CreateStructureKeys() const {
         JSONArray structure_keys;
         structure_keys.reserve(_column_order_by_keys.size());
 
@@ -171,28 +422,9 @@ public:
             structure_keys.emplace_back(key);
         }
 
-        data_obj["structure"] = std::move(structure_keys);
-        table_props["data"] = std::move(data_obj);
-        table_props["structure"] = _structure;
-
-        return table_props;
+        return structure_keys;
     }
 
-private:
-    std::string _table_name;
-    std::string _id_column;
-    std::vector<std::string> _column_order_by_keys;
-    std::vector<JSONArray> _rows;
-    JSONObject _structure;
-    std::pair<std::string, std::string> _order_by{"id", "DESC"};
-    bool _is_auto_save_enabled = false;
-    bool _is_refresh_button_enabled = true;
-    bool _is_bookmarks_button_enabled = true;
-    bool _is_export_button_enabled = true;
-    bool _is_total_row_enabled = false;
-    std::string _total_data_title;
-    JSONArray _total_data;
-
     static JSONObject ConvertFilterToJson(const FilterConfig& filter_config) {
         JSONObject json_object;
         json_object["type"] = ConvertFilterTypeToString(filter_config.type);
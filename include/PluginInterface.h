@@ -14,6 +14,13 @@
 #include "sbxTableBuilder/SBXTableBuilder.hpp"
 #include "structures/PluginStructures.h"
 #include "utils/Utils.h"
+#include "utils/ReportOptionsParser.h"
+#include "services/PluginRuntime.h"
+#include "services/ReportContext.h"
+#include "services/ReportJobs.h"
+#include "services/ReportMetrics.h"
+#include "services/ReportVerifier.h"
+#include "services/Reports.h"
 
 extern "C" {
     void AboutReport(rapidjson::Value& request,
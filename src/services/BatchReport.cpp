@@ -0,0 +1,200 @@
+#include "BatchReport.h"
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <tuple>
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/EquityReport.h"
+#include "services/PluginRuntime.h"
+#include "services/ReportCommon.h"
+#include "utils/Snapshots.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Merged range of one group mask, fetched once for every entry it covers
+        struct BatchFetch {
+            std::string               group_mask;
+            time_t                    from = 0;
+            time_t                    to   = 0;
+            std::vector<EquityRecord> records;
+            bool                      is_fetched = false;
+        };
+
+        struct BatchTable {
+            BatchTable(std::string table_name, const ReportOptions& options)
+                : name(std::move(table_name)),
+                  table_builder(name),
+                  window(options.row_offset, options.row_limit) {}
+
+            std::string  name;
+            TableBuilder table_builder;
+            Total        total{};
+            RowWindow    window;
+        };
+
+        // Passes the batch cancellation to a table; tables do not report progress
+        class TableTask final : public ReportTask {
+        public:
+            explicit TableTask(const ReportTask& batch) : _batch(batch) {}
+
+            [[nodiscard]] bool IsCancelled() const override { return _batch.IsCancelled(); }
+
+        private:
+            const ReportTask& _batch;
+        };
+
+        std::string CreateHeading(const ReportRange& range) {
+            return range.group_mask + ": " + utils::FormatTimestampToString(range.from) + " - " +
+                   utils::FormatTimestampToString(range.to);
+        }
+    } // namespace
+
+    bool BuildBatchReport(const ReportOptions&                options,
+                          CServerInterface*                   server,
+                          ReportTask&                         task,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        const auto& batch = options.batch;
+
+        // Entries sorted by mask and start, so overlapping ranges of a mask are adjacent
+        std::vector<size_t> entry_order(batch.size());
+        std::iota(entry_order.begin(), entry_order.end(), size_t{0});
+        std::sort(entry_order.begin(), entry_order.end(), [&](size_t lhs, size_t rhs) {
+            return std::tie(batch[lhs].group_mask, batch[lhs].from) <
+                   std::tie(batch[rhs].group_mask, batch[rhs].from);
+        });
+
+        std::vector<BatchFetch> fetches;
+        std::vector<size_t>     fetch_of(batch.size());
+
+        for (const size_t index : entry_order) {
+            const ReportRange& range = batch[index];
+            if (fetches.empty() || fetches.back().group_mask != range.group_mask ||
+                range.from > fetches.back().to) {
+                fetches.push_back({range.group_mask, range.from, range.to, {}, false});
+            } else {
+                fetches.back().to = std::max(fetches.back().to, range.to);
+            }
+            fetch_of[index] = fetches.size() - 1;
+        }
+
+        // Fetches and the group list run side by side, the last chunk takes the groups
+        PluginRuntime&           runtime = PluginRuntime::Instance(options.threads);
+        std::vector<GroupRecord> group_vector;
+
+        RunChunks(runtime.Pool(), fetches.size() + 1, [&](size_t chunk) {
+            if (chunk == fetches.size()) {
+                try {
+                    server->GetAllGroups(&group_vector);
+                } catch (const std::exception& e) {
+                    std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+                }
+                return;
+            }
+
+            BatchFetch&   fetch         = fetches[chunk];
+            ReportOptions fetch_options = options;
+            fetch_options.group_mask    = fetch.group_mask;
+            fetch.is_fetched =
+                FetchRangeRecords(fetch_options, server, fetch.from, fetch.to, fetch.records);
+        });
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        if (std::any_of(fetches.begin(), fetches.end(), [](const BatchFetch& fetch) {
+                return !fetch.is_fetched;
+            })) {
+            throw FetchError();
+        }
+        task.SetProgress(0.2);
+
+        // Daily rates cover the union of the entry ranges
+        ReportOptions rate_options = options;
+        for (const auto& fetch : fetches) {
+            rate_options.from = std::min(rate_options.from, fetch.from);
+            rate_options.to   = std::max(rate_options.to, fetch.to);
+        }
+
+        ConversionService conversion(server, runtime, rate_options);
+        for (const auto& fetch : fetches) {
+            conversion.Prefetch(fetch.records);
+        }
+
+        const std::vector<FilterOption> group_options = CreateGroupOptions(group_vector);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.3);
+
+        std::deque<BatchTable> tables;
+        for (size_t index = 0; index < batch.size(); ++index) {
+            tables.emplace_back("DailyEquityReportTable" + std::to_string(index + 1), options);
+            tables.back().total.currency = options.currency;
+        }
+
+        // Conversion rates are only read from here on, tables are filled concurrently
+        TableTask table_task(task);
+
+        RunChunks(runtime.Pool(), batch.size(), [&](size_t index) {
+            const ReportRange& range = batch[index];
+            const BatchFetch&  fetch = fetches[fetch_of[index]];
+            BatchTable&        table = tables[index];
+
+            std::vector<EquityRecord> records;
+            if (fetch.from == range.from && fetch.to == range.to) {
+                records = fetch.records;
+            } else {
+                std::copy_if(fetch.records.begin(),
+                             fetch.records.end(),
+                             std::back_inserter(records),
+                             [&](const EquityRecord& record) {
+                                 return record.create_time >= range.from &&
+                                        record.create_time <= range.to;
+                             });
+            }
+            utils::SelectSnapshots(records, options.snapshot);
+
+            FillEquityTable(options,
+                            records,
+                            group_options,
+                            conversion,
+                            table.name,
+                            table_task,
+                            table.table_builder,
+                            table.total,
+                            table.window);
+        });
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.9);
+
+        report = utils::ToJson(Column({h1({text("Daily Equity Report")})}), allocator);
+
+        for (size_t index = 0; index < batch.size(); ++index) {
+            Value heading_node = utils::ToJson(h2({text(CreateHeading(batch[index]))}), allocator);
+            utils::AppendChild(report, heading_node, allocator);
+
+            Value table_node = utils::CreateTableNode(tables[index].table_builder, allocator);
+            utils::AppendChild(report, table_node, allocator);
+
+            AppendPageNotice(tables[index].window, report, allocator);
+        }
+
+        AppendConversionNotice(conversion, report, allocator);
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds one equity table per batch entry into a single content node.
+     *
+     * Entries of the same group mask with overlapping ranges share one fetch of the merged
+     * range. Fetches and tables are built in parallel on the runtime pool, and the group
+     * list, the conversion rates and the group filter options are resolved once for all
+     * tables. The other request options apply to every table.
+     *
+     * Returns false when the task was cancelled at one of the checkpoints.
+     */
+    bool BuildBatchReport(const ReportOptions&                options,
+                          CServerInterface*                   server,
+                          ReportTask&                         task,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator);
+} // namespace services
@@ -0,0 +1,216 @@
+#include "BoundedReport.h"
+
+#include <algorithm>
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/EquityReport.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "services/ReportStatistics.h"
+#include "structures/EquityTableSchema.h"
+#include "utils/FlatLoginMap.h"
+#include "utils/RowSpill.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr time_t day_seconds = 86400;
+    } // namespace
+
+    bool BuildBoundedEquityReport(const ReportOptions&                options,
+                                  CServerInterface*                   server,
+                                  ReportTask&                         task,
+                                  rapidjson::Value&                   report,
+                                  rapidjson::Document::AllocatorType& allocator) {
+        utils::RowSpill spill;
+        if (!spill.IsOpen()) {
+            return BuildEquityReport(options, server, task, report, allocator);
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context      = ReportContext::Acquire();
+        auto&          day_records  = context.equity_vector;
+        auto&          snapshots    = context.previous_vector;
+        auto&          group_vector = context.group_vector;
+
+        try {
+            server->GetAllGroups(&group_vector);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+
+        PluginRuntime&    runtime = PluginRuntime::Instance(options.threads);
+        ConversionService conversion(server, runtime, options);
+
+        Total total{};
+        total.currency = conversion.TargetCurrency();
+
+        // Statistics are streamed with the rows, their memory does not grow with the range
+        const MarginCallLevels margin_calls = CreateMarginCallLevels(group_vector);
+        EquityStatistics       statistics(margin_calls);
+
+        RowWindow window(options.row_offset, options.row_limit);
+
+        // A row the spill cannot hold makes the report fall back to the in-memory build
+        bool is_spilled = true;
+
+        const auto emit_row = [&](const EquityRecord& record) {
+            const ConversionRate& rate = conversion.Find(record);
+            if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                return;
+            }
+
+            const double       multiplier = rate.is_resolved ? rate.multiplier : 1.0;
+            const std::string& currency =
+                rate.is_resolved ? conversion.TargetCurrency() : record.currency;
+
+            if (rate.is_resolved) {
+                AccumulateTotal(total, record, multiplier);
+            }
+            if (options.statistics) {
+                statistics.Add(record, rate);
+            }
+
+            if (!window.Take()) {
+                return;
+            }
+
+            is_spilled = spill.Append(
+                EncodeSchemaRow(equity_table_schema, EquityRowView{record, multiplier, currency}));
+        };
+
+        // Login -> position of its kept snapshot, as in utils::SelectSnapshots
+        utils::FlatLoginMap<size_t> positions;
+
+        const time_t first_day = utils::DayStart(options.from);
+        const size_t days =
+            options.to >= options.from
+                ? static_cast<size_t>((utils::DayStart(options.to) - first_day) / day_seconds) + 1
+                : 0;
+
+        for (size_t day = 0; day < days && is_spilled; ++day) {
+            if (task.IsCancelled()) {
+                return false;
+            }
+
+            const time_t day_start  = first_day + static_cast<time_t>(day) * day_seconds;
+            const time_t shard_from = std::max(options.from, day_start);
+            const time_t shard_to   = std::min(options.to, day_start + day_seconds - 1);
+
+            day_records.clear();
+            if (!FetchRangeRecords(options, server, shard_from, shard_to, day_records)) {
+                throw FetchError();
+            }
+
+            conversion.Prefetch(day_records);
+
+            for (auto& record : day_records) {
+                if (options.snapshot == SnapshotMode::All) {
+                    emit_row(record);
+                    continue;
+                }
+
+                auto [position, is_inserted] = positions.TryEmplace(record.login);
+                if (is_inserted) {
+                    *position = snapshots.size();
+                    snapshots.push_back(std::move(record));
+                    continue;
+                }
+
+                EquityRecord& current     = snapshots[*position];
+                const bool    is_replaced = options.snapshot == SnapshotMode::Latest
+                                                ? record.create_time > current.create_time
+                                                : record.create_time < current.create_time;
+                if (is_replaced) {
+                    current = std::move(record);
+                }
+            }
+
+            task.SetProgress(0.8 * static_cast<double>(day + 1) / days);
+        }
+
+        const std::string order_by = ResolveOrderColumn(equity_table_schema, options.order_by);
+
+        // One record per login is bounded by the account count and can be put in order
+        if (is_spilled && options.snapshot != SnapshotMode::All) {
+            const auto row_order = SortSchemaRows(
+                equity_table_schema,
+                order_by,
+                options.order_descending,
+                snapshots.size(),
+                [&](size_t index) {
+                    const EquityRecord&   record = snapshots[index];
+                    const ConversionRate& rate   = conversion.Find(record);
+                    return EquityRowView{record,
+                                         rate.is_resolved ? rate.multiplier : 1.0,
+                                         rate.is_resolved ? conversion.TargetCurrency()
+                                                          : record.currency};
+                },
+                runtime.Pool());
+
+            for (const uint32_t index : row_order) {
+                if (!is_spilled) {
+                    break;
+                }
+                emit_row(snapshots[index]);
+            }
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        if (!is_spilled) {
+            return BuildEquityReport(options, server, task, report, allocator);
+        }
+        task.SetProgress(0.9);
+
+        // Compact rows need every row at once, so spilled rows are always sent plain
+        TableBuilder& table_builder = context.table_builder;
+        SetupReportTable(table_builder,
+                         "DailyEquityReportTable",
+                         false,
+                         order_by,
+                         options.order_descending);
+        AddSchemaColumns(table_builder, equity_table_schema, CreateGroupOptions(group_vector));
+        table_builder.SetTotalData(CreateTotalData(total));
+
+        bool is_encoded = false;
+        if (options.rows_codec != utils::CompressionCodec::None) {
+            std::string rows_text;
+            std::string compressed;
+            if (spill.ReadText(&rows_text) &&
+                utils::Compress(rows_text, options.rows_codec, &compressed)) {
+                table_builder.SetEncodedRows(utils::CompressionCodecName(options.rows_codec),
+                                             utils::EncodeBase64(compressed));
+                is_encoded = true;
+            }
+        }
+
+        report = utils::ToJson(Column({h1({text("Daily Equity Report")})}), allocator);
+
+        Value table_node = utils::CreateTableNode(table_builder, allocator);
+        if (!is_encoded) {
+            Value rows;
+            if (!spill.ReadRows(rows, allocator)) {
+                return BuildEquityReport(options, server, task, report, allocator);
+            }
+            table_node["props"]["data"]["rows"] = rows;
+        }
+        utils::AppendChild(report, table_node, allocator);
+
+        AppendPageNotice(window, report, allocator);
+        AppendConversionNotice(conversion, report, allocator);
+
+        if (options.statistics) {
+            Value statistics_node = statistics.CreateNode(conversion.TargetCurrency(), allocator);
+            utils::AppendChild(report, statistics_node, allocator);
+        }
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds the equity report with memory bounded by one day of records.
+     *
+     * The range is fetched one day shard at a time, totals are accumulated as records
+     * arrive and formatted rows are spilled to a temporary file that is read back into
+     * the response at the end. Latest/first snapshots keep one record per login. When the
+     * spill cannot be created, written or read back, the report is built in memory instead.
+     * Returns false when the task was cancelled.
+     */
+    bool BuildBoundedEquityReport(const ReportOptions&                options,
+                                  CServerInterface*                   server,
+                                  ReportTask&                         task,
+                                  rapidjson::Value&                   report,
+                                  rapidjson::Document::AllocatorType& allocator);
+} // namespace services
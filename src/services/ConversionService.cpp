@@ -0,0 +1,155 @@
+#include "ConversionService.h"
+
+#include <cmath>
+#include <future>
+#include <unordered_set>
+
+#include "services/ReportMetrics.h"
+
+namespace services {
+    namespace {
+        const ConversionRate unresolved_rate{};
+
+        std::string RateKey(const std::string& from, const std::string& to) {
+            return from + "/" + to;
+        }
+    } // namespace
+
+    RatePolicy ParseRatePolicy(const std::string& name) {
+        if (name == "skip") {
+            return RatePolicy::Skip;
+        }
+        if (name == "last_known") {
+            return RatePolicy::LastKnown;
+        }
+        return RatePolicy::Mark;
+    }
+
+    ConversionService::ConversionService(CServerInterface* server,
+                                         PluginRuntime&    runtime,
+                                         std::string       target_currency,
+                                         RatePolicy        policy)
+        : _server(server),
+          _runtime(runtime),
+          _target_currency(std::move(target_currency)),
+          _policy(policy) {
+        _rates[_target_currency] = {1.0, true, false};
+    }
+
+    ConversionService::ConversionService(CServerInterface*    server,
+                                         PluginRuntime&       runtime,
+                                         const ReportOptions& options)
+        : ConversionService(
+              server, runtime, options.currency, ParseRatePolicy(options.rate_policy)) {
+        _is_historical = options.historical_rates;
+        _from          = options.from;
+        _to            = options.to;
+    }
+
+    void ConversionService::Prefetch(const std::vector<EquityRecord>& records) {
+        std::unordered_set<std::string> currencies;
+        for (const auto& record : records) {
+            if (!_rates.contains(record.currency)) {
+                currencies.insert(record.currency);
+            }
+        }
+
+        Prefetch(currencies);
+    }
+
+    void ConversionService::Prefetch(const std::unordered_set<std::string>& currencies) {
+        PhaseTimer timer(MetricPhase::Rates);
+
+        std::vector<std::pair<std::string, std::future<ResolvedCurrency>>> requests;
+        requests.reserve(currencies.size());
+
+        for (const auto& currency : currencies) {
+            if (_rates.contains(currency)) {
+                continue;
+            }
+
+            auto request = _runtime.Pool().Submit([this, currency] {
+                return _is_historical ? ResolveHistorical(currency)
+                                      : ResolvedCurrency{Resolve(currency), {}};
+            });
+            requests.emplace_back(currency, std::move(request));
+        }
+
+        for (auto& [currency, request] : requests) {
+            ResolvedCurrency resolved = _runtime.Pool().Await(request);
+            _rates[currency]          = resolved.spot;
+            if (!resolved.daily.IsEmpty()) {
+                _daily_rates.emplace(currency, std::move(resolved.daily));
+            }
+        }
+    }
+
+    const ConversionRate& ConversionService::Find(const std::string& currency) const {
+        const auto it = _rates.find(currency);
+        return it != _rates.end() ? it->second : unresolved_rate;
+    }
+
+    const ConversionRate& ConversionService::Find(const EquityRecord& record) const {
+        return Find(record.currency, record.create_time);
+    }
+
+    const ConversionRate& ConversionService::Find(const std::string& currency, time_t time) const {
+        if (!_daily_rates.empty()) {
+            if (const auto it = _daily_rates.find(currency); it != _daily_rates.end()) {
+                return it->second.Find(time);
+            }
+        }
+        return Find(currency);
+    }
+
+    std::vector<std::string> ConversionService::FailedCurrencies() const {
+        std::vector<std::string> failed;
+        for (const auto& [currency, rate] : _rates) {
+            if (!rate.is_resolved || rate.is_stale) {
+                failed.push_back(currency);
+            }
+        }
+        return failed;
+    }
+
+    ConversionService::ResolvedCurrency ConversionService::ResolveHistorical(
+        const std::string& currency) const {
+        DailyRates daily = DailyRates::Load(_server, currency, _target_currency, _from, _to);
+        if (daily.IsEmpty()) {
+            return {Resolve(currency), {}};
+        }
+
+        // Rows are converted by day, the plain lookup answers with the last close
+        const ConversionRate latest = daily.Latest();
+        return {latest, std::move(daily)};
+    }
+
+    ConversionRate ConversionService::Resolve(const std::string& currency) const {
+        const std::string key        = RateKey(currency, _target_currency);
+        double            multiplier = 0.0;
+        int               result     = RET_ERROR;
+
+        try {
+            result = _server->CalculateConvertRateByCurrency(
+                currency, _target_currency, OP_SELL, &multiplier);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+
+        if (result == RET_OK && std::isfinite(multiplier) && multiplier > 0.0) {
+            _runtime.LastKnownRates().Set(key, multiplier);
+            return {multiplier, true, false};
+        }
+
+        std::cerr << "[DailyEquityReportInterface]: no conversion rate " << key
+                  << ", code: " << result << std::endl;
+
+        if (_policy == RatePolicy::LastKnown) {
+            if (const auto last_known = _runtime.LastKnownRates().Find(key)) {
+                return {*last_known, true, true};
+            }
+        }
+
+        return {};
+    }
+} // namespace services
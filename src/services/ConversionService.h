@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Structures.h"
+#include "services/DailyRates.h"
+#include "services/PluginRuntime.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    // What to do with rows whose currency has no conversion rate
+    enum class RatePolicy {
+        Skip,     // Drop the row from the table and the totals
+        Mark,     // Show the row unconverted in its own currency, keep it out of the totals
+        LastKnown // Use the last rate resolved by any report, otherwise behave as Mark
+    };
+
+    RatePolicy ParseRatePolicy(const std::string& name);
+
+    /**
+     * Resolves conversion rates for all currencies of a report before rows are formatted.
+     *
+     * Rates are requested concurrently on the runtime pool, one server call per distinct
+     * currency. Successfully resolved rates are remembered in the runtime for the LastKnown policy.
+     *
+     * With historical rates, records are converted at the daily close of their own day taken
+     * from the candles of the currency pair; currencies without candles use the spot rate.
+     */
+    class ConversionService {
+    public:
+        ConversionService(CServerInterface* server,
+                          PluginRuntime&    runtime,
+                          std::string       target_currency,
+                          RatePolicy        policy);
+
+        // Target currency, policy and rate source of the request
+        ConversionService(CServerInterface*    server,
+                          PluginRuntime&       runtime,
+                          const ReportOptions& options);
+
+        // Collects the distinct currencies of the records in one scan and resolves them
+        void Prefetch(const std::vector<EquityRecord>& records);
+
+        // Resolves the currencies that are not known yet
+        void Prefetch(const std::unordered_set<std::string>& currencies);
+
+        [[nodiscard]] const ConversionRate& Find(const std::string& currency) const;
+
+        // Rate of the record currency on the record day
+        [[nodiscard]] const ConversionRate& Find(const EquityRecord& record) const;
+
+        // Rate of the currency on the day of the time, the spot rate without historical rates
+        [[nodiscard]] const ConversionRate& Find(const std::string& currency, time_t time) const;
+
+        // Currencies that could not be resolved, including those served by a stale rate
+        [[nodiscard]] std::vector<std::string> FailedCurrencies() const;
+
+        [[nodiscard]] const std::string& TargetCurrency() const { return _target_currency; }
+        [[nodiscard]] RatePolicy         Policy() const { return _policy; }
+
+    private:
+        struct ResolvedCurrency {
+            ConversionRate spot;
+            DailyRates     daily;
+        };
+
+        ConversionRate Resolve(const std::string& currency) const;
+
+        ResolvedCurrency ResolveHistorical(const std::string& currency) const;
+
+        CServerInterface*                               _server;
+        PluginRuntime&                                  _runtime;
+        std::string                                     _target_currency;
+        RatePolicy                                      _policy;
+        std::unordered_map<std::string, ConversionRate> _rates;
+        std::unordered_map<std::string, DailyRates>     _daily_rates;
+        bool                                            _is_historical = false;
+        time_t                                          _from          = 0;
+        time_t                                          _to            = 0;
+    };
+} // namespace services
@@ -0,0 +1,88 @@
+#include "DailyRates.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr time_t day_seconds = 86400;
+
+        // Candles fetched before the range, so its first days can carry a previous close
+        constexpr time_t lookback = 7 * day_seconds;
+
+        const char* const daily_frame = "D1";
+    } // namespace
+
+    DailyRates DailyRates::Load(CServerInterface*  server,
+                                const std::string& currency,
+                                const std::string& target_currency,
+                                time_t             from,
+                                time_t             to) {
+        DailyRates rates;
+
+        const time_t first_day = utils::DayStart(from);
+        const time_t last_day  = utils::DayStart(to);
+
+        // CUR/TARGET quotes the multiplier directly, TARGET/CUR its inverse
+        bool is_inverted = false;
+        auto candles = LoadCandles(server, currency + target_currency, first_day - lookback, to);
+        if (candles.empty()) {
+            is_inverted = true;
+            candles = LoadCandles(server, target_currency + currency, first_day - lookback, to);
+        }
+        if (candles.empty()) {
+            return rates;
+        }
+
+        rates._first_day = first_day;
+        rates._days.resize(static_cast<size_t>((last_day - first_day) / day_seconds) + 1);
+
+        // Walks the days and the candles together, keeping the last close seen
+        size_t candle = 0;
+        double close  = candles.front().close;
+        for (size_t day = 0; day < rates._days.size(); ++day) {
+            const time_t day_end = first_day + static_cast<time_t>(day + 1) * day_seconds;
+            while (candle < candles.size() && candles[candle].time < day_end) {
+                close = candles[candle++].close;
+            }
+            rates._days[day] = {is_inverted ? 1.0 / close : close, true, false};
+        }
+
+        return rates;
+    }
+
+    const ConversionRate& DailyRates::Find(time_t timestamp) const {
+        const time_t offset = utils::DayStart(timestamp) - _first_day;
+        const size_t day    = offset > 0 ? static_cast<size_t>(offset / day_seconds) : 0;
+        return _days[std::min(day, _days.size() - 1)];
+    }
+
+    std::vector<CandleRecord> DailyRates::LoadCandles(CServerInterface*  server,
+                                                      const std::string& symbol,
+                                                      time_t             from,
+                                                      time_t             to) {
+        std::vector<CandleRecord> candles;
+        int                       result = RET_ERROR;
+
+        try {
+            result = server->GetCandles(symbol, daily_frame, from, to, &candles);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+
+        if (result != RET_OK) {
+            return {};
+        }
+
+        // Closes that cannot be a rate are dropped, the previous day is carried instead
+        std::erase_if(candles, [](const CandleRecord& record) {
+            return !std::isfinite(record.close) || record.close <= 0.0;
+        });
+        std::sort(candles.begin(), candles.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.time < rhs.time;
+        });
+        return candles;
+    }
+} // namespace services
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "Structures.h"
+
+namespace services {
+    struct ConversionRate {
+        double multiplier  = 1.0;
+        bool   is_resolved = false;
+        bool   is_stale    = false; // Taken from the last known rates
+    };
+
+    /**
+     * Conversion rates of one currency by day, built from daily candle closes.
+     *
+     * The array is dense over the days of the report range: a day without a candle takes the
+     * close of the previous one, and days before the first candle take its close.
+     */
+    class DailyRates {
+    public:
+        // Empty when no candles of either symbol order were found
+        static DailyRates Load(CServerInterface*  server,
+                               const std::string& currency,
+                               const std::string& target_currency,
+                               time_t             from,
+                               time_t             to);
+
+        [[nodiscard]] bool IsEmpty() const { return _days.empty(); }
+
+        // Rate of the day containing the timestamp, clamped to the loaded days
+        [[nodiscard]] const ConversionRate& Find(time_t timestamp) const;
+
+        // Rate of the last loaded day
+        [[nodiscard]] const ConversionRate& Latest() const { return _days.back(); }
+
+    private:
+        // Closes of "symbol" by time, empty when the server has none
+        static std::vector<CandleRecord> LoadCandles(CServerInterface*  server,
+                                                     const std::string& symbol,
+                                                     time_t             from,
+                                                     time_t             to);
+
+        time_t                      _first_day = 0;
+        std::vector<ConversionRate> _days;
+    };
+} // namespace services
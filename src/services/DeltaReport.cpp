@@ -0,0 +1,228 @@
+#include "DeltaReport.h"
+
+#include <algorithm>
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "structures/DeltaTableSchema.h"
+#include "utils/RadixSort.h"
+#include "utils/Snapshots.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr time_t day_seconds = 86400;
+
+        // Joined row kept until the rows are put in the requested order
+        struct DeltaRow {
+            EquityRecord delta;
+            const char*  status;
+            bool         is_resolved;
+        };
+
+        // Converted numeric fields of current minus base; a missing side counts as zero
+        EquityRecord SubtractRecords(const EquityRecord* current,
+                                     double              current_multiplier,
+                                     const EquityRecord* base,
+                                     double              base_multiplier) {
+            const EquityRecord& source = current ? *current : *base;
+
+            EquityRecord delta;
+            delta.login       = source.login;
+            delta.create_time = source.create_time;
+            delta.group       = source.group;
+            delta.currency    = source.currency;
+
+            for (double EquityRecord::* field : {&EquityRecord::balance,
+                                                 &EquityRecord::prevbalance,
+                                                 &EquityRecord::credit,
+                                                 &EquityRecord::equity,
+                                                 &EquityRecord::profit,
+                                                 &EquityRecord::storage,
+                                                 &EquityRecord::commission,
+                                                 &EquityRecord::margin,
+                                                 &EquityRecord::margin_free}) {
+                const double current_value = current ? current->*field * current_multiplier : 0.0;
+                const double base_value    = base ? base->*field * base_multiplier : 0.0;
+                delta.*field               = current_value - base_value;
+            }
+
+            // Margin level is a ratio and is not converted
+            delta.margin_level =
+                (current ? current->margin_level : 0.0) - (base ? base->margin_level : 0.0);
+
+            return delta;
+        }
+
+        bool FetchDay(const ReportOptions&       options,
+                      CServerInterface*          server,
+                      time_t                     timestamp,
+                      std::vector<EquityRecord>* records) {
+            const time_t day_start = utils::DayStart(timestamp);
+            const time_t day_end   = day_start + day_seconds - 1;
+            if (!FetchRangeRecords(options, server, day_start, day_end, *records)) {
+                return false;
+            }
+
+            utils::SelectSnapshots(*records, SnapshotMode::Latest);
+            return true;
+        }
+    } // namespace
+
+    bool BuildDeltaReport(const ReportOptions&                options,
+                          CServerInterface*                   server,
+                          ReportTask&                         task,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context        = ReportContext::Acquire();
+        auto&          base_vector    = context.previous_vector;
+        auto&          current_vector = context.equity_vector;
+        auto&          group_vector   = context.group_vector;
+
+        // A missing day would show every login as opened or closed, so the report fails
+        if (!FetchDay(options, server, options.from, &base_vector)) {
+            throw FetchError();
+        }
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        if (!FetchDay(options, server, options.to, &current_vector)) {
+            throw FetchError();
+        }
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        try {
+            server->GetAllGroups(&group_vector);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+        task.SetProgress(0.3);
+
+        PluginRuntime&    runtime = PluginRuntime::Instance(options.threads);
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(base_vector);
+        conversion.Prefetch(current_vector);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        const auto base_order = utils::RadixSortIndices(base_vector.size(), [&](size_t index) {
+            return utils::LoginSortKey(base_vector[index].login);
+        });
+        const auto current_order =
+            utils::RadixSortIndices(current_vector.size(), [&](size_t index) {
+                return utils::LoginSortKey(current_vector[index].login);
+            });
+        task.SetProgress(0.5);
+
+        Total total{};
+        total.currency = conversion.TargetCurrency();
+
+        std::vector<DeltaRow> rows;
+        rows.reserve(std::max(base_order.size(), current_order.size()));
+
+        // Merge-join of the two login-ordered snapshots
+        size_t base_index    = 0;
+        size_t current_index = 0;
+        while (base_index < base_order.size() || current_index < current_order.size()) {
+            const EquityRecord* base =
+                base_index < base_order.size() ? &base_vector[base_order[base_index]] : nullptr;
+            const EquityRecord* current = current_index < current_order.size()
+                                              ? &current_vector[current_order[current_index]]
+                                              : nullptr;
+
+            if (base && current && base->login != current->login) {
+                if (base->login < current->login) {
+                    current = nullptr;
+                } else {
+                    base = nullptr;
+                }
+            }
+
+            base_index += base ? 1 : 0;
+            current_index += current ? 1 : 0;
+
+            const ConversionRate& base_rate =
+                base ? conversion.Find(*base) : conversion.Find(*current);
+            const ConversionRate& current_rate =
+                current ? conversion.Find(*current) : base_rate;
+            const bool is_resolved = base_rate.is_resolved && current_rate.is_resolved;
+
+            if (!is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                continue;
+            }
+
+            // Unresolved sides are compared unconverted, in the account currency
+            const EquityRecord delta = SubtractRecords(current,
+                                                       is_resolved ? current_rate.multiplier : 1.0,
+                                                       base,
+                                                       is_resolved ? base_rate.multiplier : 1.0);
+            const char* status = !base ? "new" : !current ? "closed" : "";
+
+            if (is_resolved) {
+                AccumulateTotal(total, delta, 1.0);
+            }
+
+            rows.push_back({delta, status, is_resolved});
+        }
+
+        const auto row_view = [&](size_t index) {
+            const DeltaRow& row = rows[index];
+            return DeltaRowView{row.delta,
+                                row.is_resolved ? conversion.TargetCurrency() : row.delta.currency,
+                                row.status};
+        };
+
+        const std::string order_by  = ResolveOrderColumn(delta_table_schema, options.order_by);
+        const auto        row_order = SortSchemaRows(delta_table_schema,
+                                                     order_by,
+                                                     options.order_descending,
+                                                     rows.size(),
+                                                     row_view,
+                                                     runtime.Pool());
+
+        TableBuilder& table_builder = context.table_builder;
+        SetupReportTable(table_builder,
+                         "DailyEquityDeltaTable",
+                         options.compact_rows,
+                         order_by,
+                         options.order_descending);
+        AddSchemaColumns(table_builder, delta_table_schema, CreateGroupOptions(group_vector));
+
+        RowWindow window(options.row_offset, options.row_limit);
+        for (const uint32_t index : row_order) {
+            if (window.Take()) {
+                table_builder.AddRow(EncodeSchemaRow(delta_table_schema, row_view(index)));
+            }
+        }
+
+        table_builder.SetTotalData(CreateTotalData(total));
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        utils::CompressTableRows(table_builder, options.rows_codec);
+
+        report = utils::ToJson(Column({h1({text("Daily Equity Delta Report")})}), allocator);
+
+        Value table_node = utils::CreateTableNode(table_builder, allocator);
+        utils::AppendChild(report, table_node, allocator);
+
+        AppendPageNotice(window, report, allocator);
+        AppendConversionNotice(conversion, report, allocator);
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds the per-login day-over-day delta report.
+     *
+     * Takes the latest snapshot of the day containing "from" as the base and the latest
+     * snapshot of the day containing "to" as the current state, sorts both by login and
+     * merge-joins them. Accounts missing on one side are flagged as "new" or "closed".
+     *
+     * Returns false when the task was cancelled at one of the checkpoints.
+     */
+    bool BuildDeltaReport(const ReportOptions&                options,
+                          CServerInterface*                   server,
+                          ReportTask&                         task,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator);
+} // namespace services
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "Structures.h"
+
+namespace services {
+    // Downsampled history of one login and range, immutable once published
+    struct EquityHistory {
+        std::vector<EquityRecord>             points;
+        size_t                                record_count = 0; // Records before downsampling
+        bool                                  is_open      = false; // Range reaches today
+        std::chrono::steady_clock::time_point created_at;
+    };
+} // namespace services
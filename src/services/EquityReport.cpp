@@ -0,0 +1,265 @@
+#include "EquityReport.h"
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/Exposure.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "services/ReportStatistics.h"
+#include "structures/EquityTableSchema.h"
+#include "structures/ExposureTableSchema.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Rows formatted between two cancellation checkpoints
+        constexpr size_t progress_step = 4096;
+
+        template <typename Schema, typename RowFactory>
+        bool FillTable(const ReportOptions&             options,
+                       const std::vector<EquityRecord>& records,
+                       const std::vector<FilterOption>& group_options,
+                       const ConversionService&         conversion,
+                       const std::string&               table_name,
+                       ReportTask&                      task,
+                       TableBuilder&                    table_builder,
+                       Total&                           total,
+                       RowWindow&                       window,
+                       const Schema&                    schema,
+                       RowFactory                       make_row) {
+            const std::string order_by = ResolveOrderColumn(schema, options.order_by);
+
+            SetupReportTable(table_builder,
+                             table_name,
+                             options.compact_rows,
+                             order_by,
+                             options.order_descending);
+            AddSchemaColumns(table_builder, schema, group_options);
+
+            // Rows are emitted already in the order the table is shown in
+            const auto row_order = SortSchemaRows(
+                schema,
+                order_by,
+                options.order_descending,
+                records.size(),
+                [&](size_t index) {
+                    const EquityRecord&   record = records[index];
+                    const ConversionRate& rate   = conversion.Find(record);
+                    return make_row(record,
+                                    rate.is_resolved ? rate.multiplier : 1.0,
+                                    rate.is_resolved ? conversion.TargetCurrency()
+                                                     : record.currency);
+                },
+                PluginRuntime::Instance(options.threads).Pool());
+
+            if (task.IsCancelled()) {
+                return false;
+            }
+            task.SetProgress(0.3);
+
+            for (size_t position = 0; position < row_order.size(); ++position) {
+                if (position % progress_step == 0 && position > 0) {
+                    if (task.IsCancelled()) {
+                        return false;
+                    }
+                    task.SetProgress(0.3 + 0.6 * static_cast<double>(position) / row_order.size());
+                }
+
+                const EquityRecord&   equity_record = records[row_order[position]];
+                const ConversionRate& rate          = conversion.Find(equity_record);
+
+                if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                    continue;
+                }
+
+                // Rows without a rate are shown unconverted in their own currency
+                const double       multiplier = rate.is_resolved ? rate.multiplier : 1.0;
+                const std::string& currency   = rate.is_resolved ? conversion.TargetCurrency()
+                                                                 : equity_record.currency;
+
+                if (rate.is_resolved) {
+                    AccumulateTotal(total, equity_record, multiplier);
+                }
+
+                if (!window.Take()) {
+                    continue;
+                }
+
+                table_builder.AddRow(
+                    EncodeSchemaRow(schema, make_row(equity_record, multiplier, currency)));
+            }
+
+            // Total row
+            table_builder.SetTotalData(CreateTotalData(total));
+
+            if (task.IsCancelled()) {
+                return false;
+            }
+
+            utils::CompressTableRows(table_builder, options.rows_codec);
+            return true;
+        }
+    } // namespace
+
+    bool FillEquityTable(const ReportOptions&             options,
+                         const std::vector<EquityRecord>& records,
+                         const std::vector<FilterOption>& group_options,
+                         const ConversionService&         conversion,
+                         const std::string&               table_name,
+                         ReportTask&                      task,
+                         TableBuilder&                    table_builder,
+                         Total&                           total,
+                         RowWindow&                       window,
+                         const ExposureMap*               exposure) {
+        if (exposure == nullptr) {
+            return FillTable(options,
+                             records,
+                             group_options,
+                             conversion,
+                             table_name,
+                             task,
+                             table_builder,
+                             total,
+                             window,
+                             equity_table_schema,
+                             [](const EquityRecord& record,
+                                double              multiplier,
+                                const std::string&  currency) {
+                                 return EquityRowView{record, multiplier, currency};
+                             });
+        }
+
+        // Open trades are current positions, so only the latest row of each login carries them
+        utils::FlatLoginMap<time_t> latest_times(records.size());
+        for (const auto& record : records) {
+            const auto [latest, is_inserted] = latest_times.TryEmplace(record.login);
+            if (is_inserted || *latest < record.create_time) {
+                *latest = record.create_time;
+            }
+        }
+
+        // Rows probe the login map of the open trades, built once before the table
+        return FillTable(options,
+                         records,
+                         group_options,
+                         conversion,
+                         table_name,
+                         task,
+                         table_builder,
+                         total,
+                         window,
+                         exposure_table_schema,
+                         [exposure, &latest_times](const EquityRecord& record,
+                                                   double              multiplier,
+                                                   const std::string&  currency) {
+                             const bool is_latest =
+                                 *latest_times.Find(record.login) == record.create_time;
+                             return ExposureRowView{
+                                 {record, multiplier, currency},
+                                 is_latest ? exposure->Find(record.login) : nullptr};
+                         });
+    }
+
+    bool BuildEquityReport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   report,
+                           rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context       = ReportContext::Acquire();
+        auto&          equity_vector = context.equity_vector;
+        auto&          group_vector  = context.group_vector;
+        auto&          totals_map    = context.totals_map;
+
+        PluginRuntime& runtime = PluginRuntime::Instance(options.threads);
+
+        // Open trades are fetched and joined by login while the equities load
+        std::future<std::optional<ExposureMap>> exposure_request;
+        if (options.exposure) {
+            exposure_request = runtime.Pool().Submit(
+                [server, group_mask = options.group_mask, to = options.to] {
+                    return LoadExposure(server, group_mask, to);
+                });
+        }
+
+        if (!FetchEquities(options, server, task, equity_vector)) {
+            return false;
+        }
+
+        try {
+            server->GetAllGroups(&group_vector);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.2);
+
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(equity_vector);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        Total& total   = totals_map[options.currency];
+        total.currency = options.currency;
+
+        TableBuilder& table_builder = context.table_builder;
+        RowWindow     window(options.row_offset, options.row_limit);
+
+        // Columns of a failed trade fetch stay empty, a notice below the table says so
+        std::optional<ExposureMap> exposure;
+        const ExposureMap          no_trades;
+        const ExposureMap*         exposure_map = nullptr;
+        if (exposure_request.valid()) {
+            exposure     = runtime.Pool().Await(exposure_request);
+            exposure_map = exposure ? &*exposure : &no_trades;
+        }
+
+        if (!FillEquityTable(options,
+                             equity_vector,
+                             CreateGroupOptions(group_vector),
+                             conversion,
+                             "DailyEquityReportTable",
+                             task,
+                             table_builder,
+                             total,
+                             window,
+                             exposure_map)) {
+            return false;
+        }
+
+        report = utils::ToJson(Column({h1({text("Daily Equity Report")})}), allocator);
+
+        Value table_node = utils::CreateTableNode(table_builder, allocator);
+        utils::AppendChild(report, table_node, allocator);
+
+        AppendPageNotice(window, report, allocator);
+        AppendConversionNotice(conversion, report, allocator);
+
+        if (options.exposure && !exposure) {
+            Value message_node =
+                utils::ToJson(p({text("Open trades could not be loaded, exposure is empty")}),
+                              allocator);
+            utils::AppendChild(report, message_node, allocator);
+        }
+
+        if (options.statistics) {
+            const MarginCallLevels margin_calls = CreateMarginCallLevels(group_vector);
+            const EquityStatistics statistics =
+                CollectStatistics(equity_vector, conversion, margin_calls, runtime.Pool());
+
+            Value statistics_node = statistics.CreateNode(conversion.TargetCurrency(), allocator);
+            utils::AppendChild(report, statistics_node, allocator);
+        }
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ConversionService.h"
+#include "services/Exposure.h"
+#include "services/ReportCommon.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Sets up the equity table and adds the ordered, paged rows of the records.
+     *
+     * The total covers every converted row, including those outside the page. Returns false
+     * when the task was cancelled; progress is reported between 0.3 and 0.9. With an exposure
+     * map the open trade columns of each login are added after the equity columns.
+     */
+    bool FillEquityTable(const ReportOptions&             options,
+                         const std::vector<EquityRecord>& records,
+                         const std::vector<FilterOption>& group_options,
+                         const ConversionService&         conversion,
+                         const std::string&               table_name,
+                         ReportTask&                      task,
+                         TableBuilder&                    table_builder,
+                         Total&                           total,
+                         RowWindow&                       window,
+                         const ExposureMap*               exposure = nullptr);
+
+    /**
+     * Builds the content node of the daily equity report into the given allocator.
+     *
+     * Returns false when the task was cancelled at one of the checkpoints; the content
+     * is left unspecified in that case.
+     */
+    bool BuildEquityReport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   report,
+                           rapidjson::Document::AllocatorType& allocator);
+} // namespace services
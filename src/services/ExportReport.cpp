@@ -0,0 +1,179 @@
+#include "ExportReport.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "services/ConversionService.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "structures/EquityTableSchema.h"
+#include "utils/CsvWriter.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Rows formatted between two cancellation checkpoints
+        constexpr size_t progress_step = 4096;
+
+        // Text size of a typical row, the first guess of the content buffer
+        constexpr size_t estimated_row_bytes = 128;
+
+        std::string CreateFileName(const ReportOptions& options) {
+            return "daily_equity_" + utils::FormatTimestampToString(options.from, "%Y%m%d") +
+                   "_" + utils::FormatTimestampToString(options.to, "%Y%m%d") +
+                   (options.export_format == ExportFormat::Tsv ? ".tsv" : ".csv");
+        }
+    } // namespace
+
+    bool BuildEquityExport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   attachment,
+                           rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context       = ReportContext::Acquire();
+        auto&          equity_vector = context.equity_vector;
+
+        if (!FetchEquities(options, server, task, equity_vector)) {
+            return false;
+        }
+        task.SetProgress(0.2);
+
+        PluginRuntime&    runtime = PluginRuntime::Instance(options.threads);
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(equity_vector);
+
+        const auto row_view = [&](size_t index) {
+            const EquityRecord&   record = equity_vector[index];
+            const ConversionRate& rate   = conversion.Find(record);
+            return EquityRowView{record,
+                                 rate.is_resolved ? rate.multiplier : 1.0,
+                                 rate.is_resolved ? conversion.TargetCurrency() : record.currency};
+        };
+
+        const auto row_order =
+            SortSchemaRows(equity_table_schema,
+                           ResolveOrderColumn(equity_table_schema, options.order_by),
+                           options.order_descending,
+                           equity_vector.size(),
+                           row_view,
+                           runtime.Pool());
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.3);
+
+        const char separator = options.export_format == ExportFormat::Tsv ? '\t' : ',';
+
+        const auto write_field = [](utils::CsvWriter& writer, const JSONValue& value) {
+            if (const auto* number = std::get_if<double>(&value.value)) {
+                writer.Field(*number);
+            } else if (const auto* str = std::get_if<std::string>(&value.value)) {
+                writer.Field(*str);
+            } else {
+                writer.Field(std::string_view());
+            }
+        };
+
+        // Writes the header and the rows of the page; false when cancelled
+        const auto write_text = [&](utils::CsvWriter& writer, double progress, double span) {
+            std::apply([&](const auto&... column) { (writer.Field(column.language_token), ...); },
+                       equity_table_schema);
+            writer.EndRow();
+
+            RowWindow window(options.row_offset, options.row_limit);
+
+            for (size_t position = 0; position < row_order.size(); ++position) {
+                if (position % progress_step == 0 && position > 0) {
+                    if (task.IsCancelled()) {
+                        return false;
+                    }
+                    task.SetProgress(progress +
+                                     span * static_cast<double>(position) / row_order.size());
+                }
+
+                const EquityRecord& equity_record = equity_vector[row_order[position]];
+                if (!conversion.Find(equity_record).is_resolved &&
+                    conversion.Policy() == RatePolicy::Skip) {
+                    continue;
+                }
+                if (!window.Take()) {
+                    continue;
+                }
+
+                VisitSchemaRow(equity_table_schema,
+                               row_view(row_order[position]),
+                               [&](const auto&, const JSONValue& value) {
+                                   write_field(writer, value);
+                               });
+                writer.EndRow();
+            }
+            writer.Flush();
+            return true;
+        };
+
+        attachment.SetObject();
+        attachment.AddMember("name", Value(CreateFileName(options).c_str(), allocator), allocator);
+        const char* type =
+            options.export_format == ExportFormat::Tsv ? "text/tab-separated-values" : "text/csv";
+        attachment.AddMember("type", StringRef(type), allocator);
+
+        if (options.rows_codec != utils::CompressionCodec::None) {
+            // The codecs take the whole text, so it is collected before compression
+            std::string      content;
+            utils::CsvWriter writer(separator,
+                                    [&](std::string_view chunk) { content.append(chunk); });
+            if (!write_text(writer, 0.3, 0.6)) {
+                return false;
+            }
+
+            std::string compressed;
+            if (utils::Compress(content, options.rows_codec, &compressed)) {
+                const std::string encoded = utils::EncodeBase64(compressed);
+                attachment.AddMember(
+                    "codec", StringRef(utils::CompressionCodecName(options.rows_codec)), allocator);
+                attachment.AddMember(
+                    "content", Value(encoded.data(), encoded.size(), allocator), allocator);
+            } else {
+                attachment.AddMember(
+                    "content", Value(content.data(), content.size(), allocator), allocator);
+            }
+
+            task.SetProgress(1.0);
+            return true;
+        }
+
+        // Rows are formatted once, chunk by chunk, straight into a buffer of the response
+        // allocator. It is sized from the row count and doubled by Realloc when the guess is
+        // short, so it seldom moves
+        const size_t page_rows = std::min(row_order.size(), options.row_limit);
+        size_t       capacity  = estimated_row_bytes * (page_rows + 1);
+        char*        content   = static_cast<char*>(allocator.Malloc(capacity));
+        size_t       written   = 0;
+
+        utils::CsvWriter writer(separator, [&](std::string_view chunk) {
+            if (written + chunk.size() + 1 > capacity) {
+                const size_t grown = std::max(capacity * 2, written + chunk.size() + 1);
+                content  = static_cast<char*>(allocator.Realloc(content, capacity, grown));
+                capacity = grown;
+            }
+            std::memcpy(content + written, chunk.data(), chunk.size());
+            written += chunk.size();
+        });
+        if (!write_text(writer, 0.3, 0.6)) {
+            return false;
+        }
+        content[written] = '\0';
+
+        // The buffer belongs to the response allocator and lives as long as the reply
+        attachment.AddMember(
+            "content", Value(StringRef(content, static_cast<SizeType>(written))), allocator);
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
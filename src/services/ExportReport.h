@@ -0,0 +1,25 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds the equity table as CSV or TSV text into an attachment object
+     * ({name, type, content}, plus codec when the content is compressed and base64 encoded).
+     *
+     * Rows are formatted straight from the records with the table's conversion and
+     * truncation rules; no TableBuilder rows are kept. Plain text is formatted twice, once
+     * to measure it and once into the response allocator, so it is never copied whole;
+     * compressed text is collected in full for the codec. Returns false when the task was
+     * cancelled.
+     */
+    bool BuildEquityExport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   attachment,
+                           rapidjson::Document::AllocatorType& allocator);
+} // namespace services
@@ -0,0 +1,64 @@
+#include "Exposure.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace services {
+    namespace {
+        // Trade volumes are kept in hundredths of a lot
+        constexpr double volume_per_lot = 100.0;
+    } // namespace
+
+    std::optional<ExposureMap> LoadExposure(CServerInterface*  server,
+                                            const std::string& group_mask,
+                                            time_t             to) {
+        std::vector<TradeRecord> trades;
+        try {
+            if (server->GetOpenTradesByGroup(group_mask, 0, to, &trades) != RET_OK) {
+                std::cerr << "[DailyEquityReportInterface]: GetOpenTradesByGroup failed for "
+                          << group_mask << std::endl;
+                return std::nullopt;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            return std::nullopt;
+        }
+
+        ExposureMap exposure(trades.size() / 2);
+        for (const auto& trade : trades) {
+            // Pending orders carry no exposure until they are filled
+            if (trade.cmd != OP_BUY && trade.cmd != OP_SELL) {
+                continue;
+            }
+
+            LoginExposure& login = *exposure.TryEmplace(trade.login).first;
+            const double   lots  = trade.volume / volume_per_lot;
+            const double   net   = trade.cmd == OP_BUY ? lots : -lots;
+
+            ++login.trades;
+            (trade.cmd == OP_BUY ? login.buy_lots : login.sell_lots) += lots;
+            login.profit += trade.profit;
+
+            // Logins hold few symbols, a linear scan beats hashing them
+            auto symbol = std::find_if(
+                login.symbols.begin(), login.symbols.end(), [&](const auto& held) {
+                    return held.symbol == trade.symbol;
+                });
+            if (symbol == login.symbols.end()) {
+                login.symbols.push_back({trade.symbol, net});
+            } else {
+                symbol->net_lots += net;
+            }
+        }
+
+        exposure.ForEach([](int, LoginExposure& login) {
+            std::sort(login.symbols.begin(),
+                      login.symbols.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                          return std::abs(lhs.net_lots) > std::abs(rhs.net_lots);
+                      });
+        });
+        return exposure;
+    }
+} // namespace services
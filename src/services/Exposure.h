@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ctime>
+#include <optional>
+#include <string>
+
+#include "Structures.h"
+#include "structures/ExposureTableSchema.h"
+#include "utils/FlatLoginMap.h"
+
+namespace services {
+    using ExposureMap = utils::FlatLoginMap<LoginExposure>;
+
+    /**
+     * Open trades of the group mask aggregated per login.
+     *
+     * Buy and sell market positions are summed in lots with their floating profit, and per
+     * symbol into a net volume; symbols are listed by the size of their net volume. Returns
+     * nullopt when the trades cannot be fetched.
+     */
+    std::optional<ExposureMap> LoadExposure(CServerInterface*  server,
+                                            const std::string& group_mask,
+                                            time_t             to);
+} // namespace services
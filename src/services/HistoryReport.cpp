@@ -0,0 +1,162 @@
+#include "HistoryReport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/EquityHistory.h"
+#include "services/PluginRuntime.h"
+#include "services/ReportMetrics.h"
+#include "services/ReportCommon.h"
+#include "utils/Downsample.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Past days do not change, the current one gets new records
+        constexpr auto closed_lifetime = std::chrono::hours(1);
+        constexpr auto open_lifetime   = std::chrono::minutes(1);
+
+        constexpr int money_digits = 2;
+
+        // A left-out "to" is keyed as "now", the open-day lifetime bounds how stale it gets
+        std::string CreateHistoryKey(const ReportOptions& options) {
+            return std::to_string(options.login) + '\n' + std::to_string(options.from) + '\n' +
+                   (options.is_open_ended ? "now" : std::to_string(options.to)) + '\n' +
+                   std::to_string(options.history_points);
+        }
+
+        bool IsFresh(const EquityHistory& history, std::chrono::steady_clock::time_point now) {
+            return now - history.created_at < (history.is_open ? open_lifetime : closed_lifetime);
+        }
+
+        // Fetches and downsamples the history, nullptr when the server call failed
+        std::shared_ptr<EquityHistory> LoadHistory(const ReportOptions& options,
+                                                   CServerInterface*    server) {
+            std::vector<EquityRecord> records;
+            try {
+                server->GetAccountsEquitiesByLogin(
+                    options.from, options.to, options.login, &records);
+            } catch (const std::exception& e) {
+                std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+                return nullptr;
+            }
+
+            std::stable_sort(records.begin(), records.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.create_time < rhs.create_time;
+            });
+
+            const auto kept = utils::DownsampleLttb(
+                records.size(),
+                options.history_points,
+                [&](size_t index) { return static_cast<double>(records[index].create_time); },
+                [&](size_t index) { return records[index].equity; });
+
+            auto history          = std::make_shared<EquityHistory>();
+            history->record_count = records.size();
+            history->is_open      = options.to >= utils::DayStart(std::time(nullptr));
+            history->points.reserve(kept.size());
+            for (const size_t index : kept) {
+                history->points.push_back(std::move(records[index]));
+            }
+            return history;
+        }
+    } // namespace
+
+    bool BuildHistoryReport(const ReportOptions&                options,
+                            CServerInterface*                   server,
+                            ReportTask&                         task,
+                            rapidjson::Value&                   report,
+                            rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        PluginRuntime&    runtime = PluginRuntime::Instance(options.threads);
+        const std::string key     = CreateHistoryKey(options);
+        const auto        now     = std::chrono::steady_clock::now();
+
+        const auto cached = runtime.Histories().Find(key);
+        const bool is_hit = cached && *cached && IsFresh(**cached, now);
+        ReportMetrics::Instance().CountCache(MetricCache::History, is_hit);
+
+        std::shared_ptr<const EquityHistory> history;
+        if (is_hit) {
+            history = *cached;
+        } else if (auto loaded = LoadHistory(options, server)) {
+            loaded->created_at = now;
+            runtime.Histories().EraseIf([&](const std::string&, const auto& stored) {
+                return !stored || !IsFresh(*stored, now);
+            });
+            runtime.Histories().Set(key, loaded);
+            history = std::move(loaded);
+        } else {
+            history = std::make_shared<const EquityHistory>();
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.6);
+
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(history->points);
+
+        JSONArray data;
+        data.reserve(history->points.size());
+        for (const auto& point : history->points) {
+            const ConversionRate& rate = conversion.Find(point);
+            if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                continue;
+            }
+
+            const double multiplier = rate.is_resolved ? rate.multiplier : 1.0;
+            data.emplace_back(JSONObject{
+                {"time", utils::FormatTimestampToString(point.create_time, "%Y.%m.%d %H:%M")},
+                {"equity", utils::TruncateDouble(point.equity * multiplier, money_digits)},
+                {"balance", utils::TruncateDouble(point.balance * multiplier, money_digits)},
+            });
+        }
+
+        const std::string login = std::to_string(options.login);
+        const std::string summary =
+            history->record_count == 0
+                ? "No equity records of login " + login + " in the range"
+                : "Login " + login + ": " + std::to_string(data.size()) + " points from " +
+                      std::to_string(history->record_count) + " records";
+
+        const std::string& currency = conversion.TargetCurrency();
+        const Node         content  = Column({
+            h1({text("Daily Equity History")}),
+            p({text(summary)}),
+            ResponsiveContainer(
+                {LineChart({CartesianGrid({}, {{"strokeDasharray", "3 3"}}),
+                            XAxis({}, {{"dataKey", "time"}}),
+                            YAxis(),
+                            Tooltip(),
+                            Legend(),
+                            Line({},
+                                 {{"type", "monotone"},
+                                  {"dataKey", "equity"},
+                                  {"name", "Equity (" + currency + ")"},
+                                  {"stroke", "#1677ff"},
+                                  {"dot", false}}),
+                            Line({},
+                                 {{"type", "monotone"},
+                                  {"dataKey", "balance"},
+                                  {"name", "Balance (" + currency + ")"},
+                                  {"stroke", "#52c41a"},
+                                  {"dot", false}})},
+                           {{"data", data}})},
+                {{"width", "100%"}, {"height", 400.0}}),
+        });
+
+        report = utils::ToJson(content, allocator);
+        AppendConversionNotice(conversion, report, allocator);
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds the equity history chart of one login.
+     *
+     * The records of the range are fetched with GetAccountsEquitiesByLogin and reduced to the
+     * requested number of points with LTTB on the equity, which keeps its peaks and troughs.
+     * The reduced history is cached in the runtime per login, range and point count: for an
+     * hour when the range ended before today, for a minute otherwise.
+     *
+     * Returns false when the task was cancelled at one of the checkpoints.
+     */
+    bool BuildHistoryReport(const ReportOptions&                options,
+                            CServerInterface*                   server,
+                            ReportTask&                         task,
+                            rapidjson::Value&                   report,
+                            rapidjson::Document::AllocatorType& allocator);
+} // namespace services
@@ -0,0 +1,235 @@
+#include "IntradayCache.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <unordered_map>
+
+#include "services/ReportMetrics.h"
+#include "utils/GroupMask.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr long default_ttl_ms = 2000;
+
+        constexpr time_t day_seconds = 86400;
+
+        // Stored days searched back for a previous balance, covering weekends and holidays
+        constexpr time_t previous_balance_days = 7;
+
+        // Masks whose previous balances are kept at once; all are dropped beyond it
+        constexpr size_t max_previous_balances = 64;
+
+        // Mask whose snapshot holds every group, other masks can be served from it
+        const std::string all_groups = "*";
+
+        std::chrono::milliseconds ReadTtl() {
+            if (const char* env = std::getenv("DAILY_EQUITY_INTRADAY_TTL_MS")) {
+                const long ttl = std::strtol(env, nullptr, 10);
+                if (ttl > 0) {
+                    return std::chrono::milliseconds(ttl);
+                }
+            }
+            return std::chrono::milliseconds(default_ttl_ms);
+        }
+    } // namespace
+
+    IntradayCache::IntradayCache() : _ttl(ReadTtl()) {}
+
+    IntradayCache::Records IntradayCache::Get(CServerInterface*  server,
+                                              const std::string& group_mask) {
+        std::promise<SnapshotPtr>       promise;
+        std::shared_future<SnapshotPtr> pending;
+        bool                            is_filtered = false;
+        {
+            std::lock_guard lock(_mutex);
+
+            const auto now      = std::chrono::steady_clock::now();
+            const auto is_fresh = [&](const auto it) {
+                return it != _entries.end() && now - it->second.fetched_at < _ttl;
+            };
+
+            if (const auto it = _entries.find(group_mask); is_fresh(it)) {
+                pending = it->second.snapshot;
+            } else if (const auto all = _entries.find(all_groups); is_fresh(all)) {
+                pending     = all->second.snapshot;
+                is_filtered = true;
+            } else {
+                // Masks are client input, so stale ones are dropped before a new one is added
+                std::erase_if(_entries, [&](const auto& entry) {
+                    return now - entry.second.fetched_at >= _ttl;
+                });
+                _entries[group_mask] = {promise.get_future().share(), now};
+            }
+        }
+
+        ReportMetrics::Instance().CountCache(MetricCache::Intraday, pending.valid());
+
+        // Another request owns the fetch; waiting happens outside the lock
+        if (pending.valid()) {
+            const SnapshotPtr snapshot = pending.get();
+            if (!snapshot->records) {
+                return nullptr;
+            }
+            return is_filtered ? Filter(*snapshot, group_mask) : snapshot->records;
+        }
+
+        // Without previous balances the live rows would be incomplete, so the fetch fails
+        const time_t   today_start = utils::DayStart(std::time(nullptr));
+        const Balances balances    = FindPreviousBalances(server, group_mask, today_start);
+        SnapshotPtr    snapshot    = balances ? Fetch(server, group_mask, *balances)
+                                              : std::make_shared<const Snapshot>();
+        promise.set_value(snapshot);
+
+        if (!snapshot->records || snapshot->records->empty()) {
+            // A failed or empty fetch is retried by the next request
+            std::lock_guard lock(_mutex);
+            _entries.erase(group_mask);
+        }
+
+        return snapshot->records;
+    }
+
+    void IntradayCache::Clear() {
+        std::lock_guard lock(_mutex);
+        _entries.clear();
+        _previous_balances.clear();
+    }
+
+    IntradayCache::Balances IntradayCache::FindPreviousBalances(CServerInterface*  server,
+                                                                const std::string& group_mask,
+                                                                time_t             today_start) {
+        {
+            std::lock_guard lock(_mutex);
+            const auto      it = _previous_balances.find(group_mask);
+            if (it != _previous_balances.end() && it->second.day_start == today_start) {
+                return it->second.balances;
+            }
+        }
+
+        const time_t              from = today_start - previous_balance_days * day_seconds;
+        std::vector<EquityRecord> records;
+        try {
+            if (server->GetAccountsEquitiesByGroup(from,
+                                                   today_start - 1,
+                                                   group_mask,
+                                                   &records) != RET_OK) {
+                std::cerr << "[DailyEquityReportInterface]: GetAccountsEquitiesByGroup failed for "
+                          << group_mask << std::endl;
+                return nullptr;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            return nullptr;
+        }
+
+        std::unordered_map<int, const EquityRecord*> latest;
+        for (const auto& record : records) {
+            const auto [it, is_inserted] = latest.emplace(record.login, &record);
+            if (!is_inserted && it->second->create_time < record.create_time) {
+                it->second = &record;
+            }
+        }
+
+        auto balances = std::make_shared<BalanceMap>();
+        balances->reserve(latest.size());
+        for (const auto& [login, record] : latest) {
+            balances->emplace(login, record->balance);
+        }
+
+        std::lock_guard lock(_mutex);
+        if (_previous_balances.size() >= max_previous_balances) {
+            _previous_balances.clear();
+        }
+        _previous_balances[group_mask] = {today_start, balances};
+        return balances;
+    }
+
+    IntradayCache::SnapshotPtr IntradayCache::Fetch(CServerInterface*  server,
+                                                    const std::string& group_mask,
+                                                    const BalanceMap&  previous_balances) {
+        std::vector<MarginLevel> margins;
+        std::vector<GroupRecord> group_vector;
+
+        auto snapshot = std::make_shared<Snapshot>();
+        try {
+            if (server->GetMarginLevelByGroup(group_mask, &margins) != RET_OK) {
+                std::cerr << "[DailyEquityReportInterface]: GetMarginLevelByGroup failed for "
+                          << group_mask << std::endl;
+                return snapshot;
+            }
+            server->GetAllGroups(&group_vector);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            return snapshot;
+        }
+
+        // Group name -> ID, accounts also take the currency of their group
+        std::unordered_map<std::string, uint32_t> group_ids;
+        std::vector<const std::string*>           currencies;
+
+        snapshot->groups.reserve(group_vector.size());
+        for (const auto& group : group_vector) {
+            group_ids.emplace(group.group, static_cast<uint32_t>(snapshot->groups.size()));
+            snapshot->groups.push_back(group.group);
+            currencies.push_back(&group.currency);
+        }
+
+        const time_t now     = std::time(nullptr);
+        auto         records = std::make_shared<std::vector<EquityRecord>>();
+        records->reserve(margins.size());
+        snapshot->group_ids.reserve(margins.size());
+
+        for (const auto& margin : margins) {
+            EquityRecord record;
+            record.login        = margin.login;
+            record.create_time  = now;
+            record.group        = margin.group;
+            record.balance      = margin.balance;
+            record.credit       = margin.credit;
+            record.equity       = margin.equity;
+            record.profit       = margin.profit;
+            record.storage      = margin.storage;
+            record.commission   = margin.commission;
+            record.margin       = margin.margin;
+            record.margin_free  = margin.margin_free;
+            record.margin_level = margin.margin_level;
+
+            // A login without a stored record before today is new and had no balance
+            const auto previous = previous_balances.find(margin.login);
+            record.prevbalance  = previous != previous_balances.end() ? previous->second : 0.0;
+
+            auto it = group_ids.find(margin.group);
+            if (it == group_ids.end()) {
+                // Groups missing from GetAllGroups are interned without a currency
+                const auto id = static_cast<uint32_t>(snapshot->groups.size());
+                snapshot->groups.push_back(margin.group);
+                currencies.push_back(nullptr);
+                it = group_ids.emplace(margin.group, id).first;
+            }
+            if (const std::string* currency = currencies[it->second]) {
+                record.currency = *currency;
+            }
+
+            snapshot->group_ids.push_back(it->second);
+            records->push_back(std::move(record));
+        }
+
+        snapshot->records = std::move(records);
+        return snapshot;
+    }
+
+    IntradayCache::Records IntradayCache::Filter(const Snapshot&    snapshot,
+                                                 const std::string& group_mask) {
+        const utils::GroupBitset selected = utils::GroupMask(group_mask).Select(snapshot.groups);
+
+        const auto& all_records = *snapshot.records;
+        auto        records     = std::make_shared<std::vector<EquityRecord>>();
+        for (size_t index = 0; index < all_records.size(); ++index) {
+            if (selected.Test(snapshot.group_ids[index])) {
+                records->push_back(all_records[index]);
+            }
+        }
+        return records;
+    }
+} // namespace services
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Structures.h"
+
+namespace services {
+    /**
+     * Live equity records built from GetMarginLevelByGroup, shared by concurrent reports.
+     *
+     * Entries stay fresh for a short TTL (DAILY_EQUITY_INTRADAY_TTL_MS, 2000 ms by default).
+     * Requests for a group mask that is being fetched wait for that fetch instead of starting
+     * their own, so the server sees at most one call per mask and TTL. While a snapshot of
+     * every group ("*") is fresh, other masks are filtered from it locally. Expired entries
+     * are dropped whenever a mask is fetched, so only masks seen within one TTL are kept.
+     * A failed fetch is not cached. Live records take their previous balance from the last
+     * stored record of the login before today, read once per mask and day.
+     */
+    class IntradayCache {
+    public:
+        using Records = std::shared_ptr<const std::vector<EquityRecord>>;
+
+        IntradayCache();
+
+        // Live records of the mask stamped with the fetch time; nullptr when the fetch failed
+        Records Get(CServerInterface* server, const std::string& group_mask);
+
+        void Clear();
+
+    private:
+        struct Snapshot {
+            Records                  records;
+            std::vector<uint32_t>    group_ids; // Per record, position in groups
+            std::vector<std::string> groups;    // GetAllGroups names, then unknown ones
+        };
+
+        using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+        // Balance of each login at the last stored record before the day
+        using BalanceMap = std::unordered_map<int, double>;
+        using Balances   = std::shared_ptr<const BalanceMap>;
+
+        struct Entry {
+            std::shared_future<SnapshotPtr>       snapshot;
+            std::chrono::steady_clock::time_point fetched_at;
+        };
+
+        struct PreviousBalances {
+            time_t   day_start = 0;
+            Balances balances;
+        };
+
+        static SnapshotPtr Fetch(CServerInterface*  server,
+                                 const std::string& group_mask,
+                                 const BalanceMap&  previous_balances);
+
+        // Cached for the day; nullptr when the stored records cannot be read
+        Balances FindPreviousBalances(CServerInterface*  server,
+                                      const std::string& group_mask,
+                                      time_t             today_start);
+
+        // Records of the snapshot whose group matches the mask
+        static Records Filter(const Snapshot& snapshot, const std::string& group_mask);
+
+        std::chrono::milliseconds                         _ttl;
+        std::mutex                                        _mutex;
+        std::unordered_map<std::string, Entry>            _entries;
+        std::unordered_map<std::string, PreviousBalances> _previous_balances;
+    };
+} // namespace services
@@ -0,0 +1,51 @@
+#include "PluginRuntime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace services {
+    namespace {
+        // Upper bound for requested pool sizes
+        constexpr size_t max_threads = 256;
+    } // namespace
+
+    PluginRuntime::PluginRuntime(size_t threads)
+        : _refresh_version(std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count()),
+          _pool(threads) {}
+
+    PluginRuntime& PluginRuntime::Instance(size_t requested_threads) {
+        std::lock_guard lock(_instance_mutex);
+
+        if (!_instance) {
+            _instance = std::make_unique<PluginRuntime>(ResolveThreadsCount(requested_threads));
+        }
+
+        return *_instance;
+    }
+
+    void PluginRuntime::Shutdown() {
+        std::unique_ptr<PluginRuntime> instance;
+        {
+            std::lock_guard lock(_instance_mutex);
+            instance.swap(_instance);
+        }
+    }
+
+    size_t PluginRuntime::ResolveThreadsCount(size_t requested_threads) {
+        if (requested_threads == 0) {
+            if (const char* env = std::getenv("DAILY_EQUITY_THREADS")) {
+                requested_threads = std::strtoul(env, nullptr, 10);
+            }
+        }
+
+        if (requested_threads == 0) {
+            requested_threads = std::thread::hardware_concurrency();
+        }
+
+        return std::clamp<size_t>(requested_threads, 1, max_threads);
+    }
+} // namespace services
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "services/EquityHistory.h"
+#include "services/IntradayCache.h"
+#include "services/RefreshState.h"
+#include "services/RollupCube.h"
+#include "services/ShardedMap.h"
+#include "services/ThreadPool.h"
+
+namespace services {
+    /**
+     * Plugin-wide state shared by all CreateReport invocations.
+     *
+     * Created on first use and destroyed by Shutdown() from DestroyReport(). The pool size
+     * is taken, in order, from the first request's "threads" field, the DAILY_EQUITY_THREADS
+     * environment variable, or the number of hardware threads.
+     */
+    class PluginRuntime {
+    public:
+        explicit PluginRuntime(size_t threads);
+
+        static PluginRuntime& Instance(size_t requested_threads = 0);
+
+        static void Shutdown();
+
+        ThreadPool& Pool() { return _pool; }
+
+        // Last successfully resolved conversion rates by "FROM/TO"
+        ShardedMap<std::string, double>& LastKnownRates() { return _last_known_rates; }
+
+        // Recent refresh replies by request key
+        ShardedMap<std::string, RefreshVersions>& RefreshStates() { return _refresh_states; }
+
+        // Downsampled login histories by login, range and point count
+        ShardedMap<std::string, std::shared_ptr<const EquityHistory>>& Histories() {
+            return _histories;
+        }
+
+        // Live margin-level snapshots of the intraday mode
+        IntradayCache& Intraday() { return _intraday; }
+
+        // Group, day and currency sums of closed days
+        RollupCube& Rollup() { return _rollup; }
+
+        // Refresh versions are unique across plugin restarts, they start at the load time
+        uint64_t NextRefreshVersion() { return _refresh_version.fetch_add(1) + 1; }
+
+    private:
+        static size_t ResolveThreadsCount(size_t requested_threads);
+
+        ShardedMap<std::string, double>                               _last_known_rates;
+        ShardedMap<std::string, RefreshVersions>                      _refresh_states;
+        ShardedMap<std::string, std::shared_ptr<const EquityHistory>> _histories;
+        std::atomic<uint64_t>                                         _refresh_version;
+        IntradayCache                                                 _intraday;
+        RollupCube                                                    _rollup;
+        ThreadPool                                                    _pool;
+
+        static inline std::mutex                     _instance_mutex;
+        static inline std::unique_ptr<PluginRuntime> _instance;
+    };
+} // namespace services
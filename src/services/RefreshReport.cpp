@@ -0,0 +1,286 @@
+#include "RefreshReport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "services/ConversionService.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "services/ReportMetrics.h"
+#include "structures/EquityTableSchema.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Refresh states not replaced for this long are dropped
+        constexpr auto state_lifetime = std::chrono::hours(1);
+
+        // Stored requests at most; the least recently refreshed ones go first
+        constexpr size_t max_refresh_states = 256;
+
+        // Versions kept per request, so several clients polling it each get their diff
+        constexpr size_t max_refresh_versions = 4;
+
+        using RefreshStates = ShardedMap<std::string, RefreshVersions>;
+
+        // The range as the client sent it: a left-out "to" is "now", not the parsed time
+        std::string CreateStateKey(const ReportOptions& options) {
+            return options.group_mask + '\n' + std::to_string(options.from) + '\n' +
+                   (options.is_open_ended ? "now" : std::to_string(options.to)) + '\n' +
+                   std::to_string(static_cast<int>(options.snapshot)) + '\n' + options.currency +
+                   '\n' + options.rate_policy + '\n' + options.order_by +
+                   (options.order_descending ? " desc\n" : " asc\n") +
+                   std::to_string(options.row_offset) + '\n' + std::to_string(options.row_limit) +
+                   (options.intraday ? "\nintraday" : "") +
+                   (options.historical_rates ? "\nhistorical" : "");
+        }
+
+        // Drops expired requests and the oldest ones beyond the cap, leaving room for one more
+        void PruneStates(RefreshStates& states, std::chrono::steady_clock::time_point now) {
+            states.EraseIf([&](const std::string&, const RefreshVersions& versions) {
+                return versions.empty() || now - versions.back()->created_at > state_lifetime;
+            });
+
+            std::vector<std::chrono::steady_clock::time_point> created;
+            states.ForEach([&](const std::string&, const RefreshVersions& versions) {
+                created.push_back(versions.back()->created_at);
+            });
+            if (created.size() < max_refresh_states) {
+                return;
+            }
+
+            const size_t excess = created.size() - max_refresh_states + 1;
+            std::nth_element(created.begin(), created.begin() + (excess - 1), created.end());
+            const auto cutoff = created[excess - 1];
+            states.EraseIf([&](const std::string&, const RefreshVersions& versions) {
+                return versions.back()->created_at <= cutoff;
+            });
+        }
+
+        // FNV-1a over the emitted values, so any visible change of a row changes its hash
+        uint64_t HashRow(const JSONArray& row) {
+            uint64_t   hash = 0xCBF29CE484222325ull;
+            const auto mix  = [&](const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+                }
+            };
+
+            for (const auto& value : row) {
+                if (const auto* number = std::get_if<double>(&value.value)) {
+                    mix(number, sizeof(*number));
+                } else if (const auto* str = std::get_if<std::string>(&value.value)) {
+                    mix(str->data(), str->size() + 1);
+                } else if (const auto* flag = std::get_if<bool>(&value.value)) {
+                    mix(flag, sizeof(*flag));
+                }
+            }
+            return hash;
+        }
+
+        rapidjson::Value ToValue(const JSONValue&                  value,
+                                 rapidjson::Document::AllocatorType& allocator) {
+            rapidjson::Value result;
+            ast::to_json_value(value, result, allocator);
+            return result;
+        }
+
+        // Key columns identifying a removed row
+        rapidjson::Value CreateRemovedRow(const RowKey&                       key,
+                                          bool                                is_keyed_by_login,
+                                          rapidjson::Document::AllocatorType& allocator) {
+            rapidjson::Value row(rapidjson::kArrayType);
+            row.PushBack(static_cast<double>(key.login), allocator);
+            if (!is_keyed_by_login) {
+                const std::string create_time = utils::FormatTimestampToString(key.create_time);
+                row.PushBack(rapidjson::Value(create_time.c_str(), allocator), allocator);
+            }
+            return row;
+        }
+    } // namespace
+
+    bool BuildRefreshReport(const ReportOptions&                options,
+                            CServerInterface*                   server,
+                            ReportTask&                         task,
+                            rapidjson::Value&                   report,
+                            rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context       = ReportContext::Acquire();
+        auto&          equity_vector = context.equity_vector;
+
+        if (!FetchEquities(options, server, task, equity_vector)) {
+            return false;
+        }
+        task.SetProgress(0.2);
+
+        PluginRuntime&    runtime = PluginRuntime::Instance(options.threads);
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(equity_vector);
+
+        const auto row_view = [&](size_t index) {
+            const EquityRecord&   record = equity_vector[index];
+            const ConversionRate& rate   = conversion.Find(record);
+            return EquityRowView{record,
+                                 rate.is_resolved ? rate.multiplier : 1.0,
+                                 rate.is_resolved ? conversion.TargetCurrency() : record.currency};
+        };
+
+        const auto row_order =
+            SortSchemaRows(equity_table_schema,
+                           ResolveOrderColumn(equity_table_schema, options.order_by),
+                           options.order_descending,
+                           equity_vector.size(),
+                           row_view,
+                           runtime.Pool());
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.4);
+
+        // A login has one row unless every daily record is kept
+        const bool is_keyed_by_login = options.snapshot != SnapshotMode::All;
+
+        const std::string                   state_key = CreateStateKey(options);
+        std::shared_ptr<const RefreshState> previous;
+        if (options.refresh_since != 0) {
+            if (const auto versions = runtime.RefreshStates().Find(state_key)) {
+                const auto it = std::ranges::find_if(*versions, [&](const auto& version) {
+                    return version->version == options.refresh_since;
+                });
+                if (it != versions->end()) {
+                    previous = *it;
+                }
+            }
+        }
+        if (options.refresh_since != 0) {
+            ReportMetrics::Instance().CountCache(MetricCache::Refresh, previous != nullptr);
+        }
+
+        auto state        = std::make_shared<RefreshState>();
+        state->version    = runtime.NextRefreshVersion();
+        state->created_at = std::chrono::steady_clock::now();
+        state->row_hashes.reserve(std::min(equity_vector.size(), options.row_limit));
+
+        Total total{};
+        total.currency = conversion.TargetCurrency();
+
+        Value inserted(kArrayType);
+        Value updated(kArrayType);
+        Value removed(kArrayType);
+
+        // Only the page is sent and kept; totals still cover every row
+        RowWindow window(options.row_offset, options.row_limit);
+
+        for (const uint32_t index : row_order) {
+            const EquityRecord&   record = equity_vector[index];
+            const ConversionRate& rate   = conversion.Find(record);
+
+            if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                continue;
+            }
+            if (rate.is_resolved) {
+                AccumulateTotal(total, record, rate.multiplier);
+            }
+            if (!window.Take()) {
+                continue;
+            }
+
+            const JSONArray row  = EncodeSchemaRow(equity_table_schema, row_view(index));
+            const uint64_t  hash = HashRow(row);
+            const RowKey    key{record.login, is_keyed_by_login ? 0 : record.create_time};
+
+            state->row_hashes[key] = hash;
+
+            if (previous) {
+                const auto it = previous->row_hashes.find(key);
+                if (it != previous->row_hashes.end()) {
+                    if (it->second != hash) {
+                        updated.PushBack(ToValue(row, allocator), allocator);
+                    }
+                    continue;
+                }
+            }
+            inserted.PushBack(ToValue(row, allocator), allocator);
+        }
+
+        if (previous) {
+            for (const auto& [key, hash] : previous->row_hashes) {
+                if (!state->row_hashes.contains(key)) {
+                    removed.PushBack(CreateRemovedRow(key, is_keyed_by_login, allocator),
+                                     allocator);
+                }
+            }
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        PruneStates(runtime.RefreshStates(), state->created_at);
+        runtime.RefreshStates().Update(state_key, [&](RefreshVersions& versions) {
+            if (versions.size() == max_refresh_versions) {
+                versions.erase(versions.begin());
+            }
+            versions.push_back(state);
+        });
+
+        Value structure(kArrayType);
+        std::apply(
+            [&](const auto&... column) {
+                (structure.PushBack(StringRef(column.key.data(), column.key.size()), allocator),
+                 ...);
+            },
+            equity_table_schema);
+
+        Value key_columns(kArrayType);
+        key_columns.PushBack("login", allocator);
+        if (!is_keyed_by_login) {
+            key_columns.PushBack("create_time", allocator);
+        }
+
+        Value payload(kObjectType);
+        payload.AddMember("version", state->version, allocator);
+        payload.AddMember("since", options.refresh_since, allocator);
+        payload.AddMember("full", previous == nullptr, allocator);
+        payload.AddMember("structure", structure, allocator);
+        payload.AddMember("key", key_columns, allocator);
+        payload.AddMember("inserted", inserted, allocator);
+        payload.AddMember("updated", updated, allocator);
+        payload.AddMember("removed", removed, allocator);
+        payload.AddMember("rows", static_cast<uint64_t>(window.Count()), allocator);
+        payload.AddMember("totalData", ToValue(CreateTotalData(total), allocator), allocator);
+
+        if (options.is_push) {
+            rapidjson::Document message;
+            message.SetObject();
+            message.AddMember(
+                "refresh", Value(payload, message.GetAllocator()), message.GetAllocator());
+
+            try {
+                if (options.manager_id >= 0) {
+                    server->SendToManager(options.manager_id, message);
+                } else {
+                    server->SendState(message);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            }
+
+            report.SetObject();
+            report.AddMember("version", state->version, allocator);
+            report.AddMember("pushed", true, allocator);
+        } else {
+            report = payload;
+        }
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds the rows of the equity table that changed since the client's version.
+     *
+     * The hashes of the emitted rows are kept per (group, range, snapshot, currency) in the
+     * plugin runtime under a new version. When the client holds the latest version the reply
+     * carries only inserted, updated and removed rows, otherwise every row as inserted with
+     * "full" set. Totals are always complete. With "push" the payload is sent through
+     * SendState (SendToManager with a manager_id) and the reply holds only the version.
+     * Returns false when the task was cancelled.
+     */
+    bool BuildRefreshReport(const ReportOptions&                options,
+                            CServerInterface*                   server,
+                            ReportTask&                         task,
+                            rapidjson::Value&                   report,
+                            rapidjson::Document::AllocatorType& allocator);
+} // namespace services
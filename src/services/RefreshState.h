@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+    // Identity of an emitted row: the login, plus the record time when a login has several rows
+    struct RowKey {
+        int    login       = 0;
+        time_t create_time = 0;
+
+        bool operator==(const RowKey&) const = default;
+    };
+
+    struct RowKeyHash {
+        size_t operator()(const RowKey& key) const {
+            return static_cast<size_t>(
+                (static_cast<uint64_t>(static_cast<uint32_t>(key.login)) << 32 ^
+                 static_cast<uint64_t>(key.create_time)) *
+                0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    // Row hashes of the last reply for one (group, range) request, immutable once published
+    struct RefreshState {
+        uint64_t                                         version = 0;
+        std::unordered_map<RowKey, uint64_t, RowKeyHash> row_hashes;
+        std::chrono::steady_clock::time_point            created_at;
+    };
+
+    // Recent replies of one request, oldest first, so clients at different versions get diffs
+    using RefreshVersions = std::vector<std::shared_ptr<const RefreshState>>;
+} // namespace services
@@ -0,0 +1,183 @@
+#include "ReportCommon.h"
+
+#include <algorithm>
+#include <ctime>
+#include <future>
+
+#include "services/PluginRuntime.h"
+#include "services/ReportMetrics.h"
+#include "utils/Snapshots.h"
+#include "utils/Utils.h"
+
+namespace services {
+    bool FetchRangeRecords(const ReportOptions&       options,
+                           CServerInterface*          server,
+                           time_t                     from,
+                           time_t                     to,
+                           std::vector<EquityRecord>& records) {
+        PhaseTimer timer(MetricPhase::Fetch);
+
+        const time_t today_start = utils::DayStart(std::time(nullptr));
+        const bool   is_live     = options.intraday && to >= today_start;
+        const time_t stored_to   = is_live ? std::min(to, today_start - 1) : to;
+
+        bool is_fetched = true;
+        if (from <= stored_to) {
+            try {
+                if (server->GetAccountsEquitiesByGroup(
+                        from, stored_to, options.group_mask, &records) != RET_OK) {
+                    std::cerr << "[DailyEquityReportInterface]: equity fetch failed for "
+                              << options.group_mask << std::endl;
+                    is_fetched = false;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+                is_fetched = false;
+            }
+        }
+
+        if (is_live) {
+            const auto live = PluginRuntime::Instance(options.threads)
+                                  .Intraday()
+                                  .Get(server, options.group_mask);
+            if (live) {
+                records.insert(records.end(), live->begin(), live->end());
+            } else {
+                is_fetched = false;
+            }
+        }
+
+        ReportMetrics::Instance().RecordSize(MetricSize::FetchedRows, records.size());
+        return is_fetched;
+    }
+
+    bool FetchEquities(const ReportOptions&       options,
+                       CServerInterface*          server,
+                       ReportTask&                task,
+                       std::vector<EquityRecord>& records) {
+        const bool is_fetched =
+            FetchRangeRecords(options, server, options.from, options.to, records);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        if (!is_fetched) {
+            throw FetchError();
+        }
+
+        utils::SelectSnapshots(records, options.snapshot);
+        return true;
+    }
+
+    void SetupReportTable(TableBuilder&      table_builder,
+                          const std::string& name,
+                          bool               compact_rows,
+                          const std::string& order_by,
+                          bool               is_descending) {
+        table_builder.SetName(name);
+        table_builder.SetIdColumn("login");
+        table_builder.SetOrderBy(order_by, is_descending ? "DESC" : "ASC");
+        table_builder.EnableAutoSave(false);
+        table_builder.EnableRefreshButton(false);
+        table_builder.EnableBookmarksButton(false);
+        table_builder.EnableExportButton(true);
+        table_builder.EnableTotal(true);
+        table_builder.SetTotalDataTitle("TOTAL");
+        table_builder.EnableCompactRows(compact_rows);
+    }
+
+    std::vector<FilterOption> CreateGroupOptions(const std::vector<GroupRecord>& groups) {
+        std::vector<FilterOption> group_options;
+        group_options.reserve(groups.size());
+        for (const auto& group : groups) {
+            group_options.push_back({group.group, group.group});
+        }
+        return group_options;
+    }
+
+    void AccumulateTotal(Total& total, const EquityRecord& record, double multiplier) {
+        const double floating_pl = record.equity - record.balance;
+
+        total.equity += record.equity * multiplier;
+        total.credit += record.credit * multiplier;
+        total.floating_pl += floating_pl * multiplier;
+        total.profit += record.profit * multiplier;
+        total.balance += record.balance * multiplier;
+        total.prevbalance += record.prevbalance * multiplier;
+        total.storage += record.storage * multiplier;
+        total.commission += record.commission * multiplier;
+        total.margin += record.margin * multiplier;
+        total.margin_free += record.margin_free * multiplier;
+    }
+
+    JSONArray CreateTotalData(const Total& total) {
+        JSONArray totals_array;
+        totals_array.emplace_back(JSONObject{
+            {"equity", utils::TruncateDouble(total.equity, 2)},
+            {"credit", utils::TruncateDouble(total.credit, 2)},
+            {"floating_pl", utils::TruncateDouble(total.floating_pl, 2)},
+            {"profit", utils::TruncateDouble(total.profit, 2)},
+            {"prevbalance", utils::TruncateDouble(total.prevbalance, 2)},
+            {"balance", utils::TruncateDouble(total.balance, 2)},
+            {"storage", utils::TruncateDouble(total.storage, 2)},
+            {"commission", utils::TruncateDouble(total.commission, 2)},
+            {"margin", utils::TruncateDouble(total.margin, 2)},
+            {"margin_free", utils::TruncateDouble(total.margin_free, 2)},
+            {"currency", total.currency},
+        });
+        return totals_array;
+    }
+
+    void RunChunks(ThreadPool& pool, size_t chunks, const std::function<void(size_t)>& function) {
+        std::vector<std::future<void>> pending;
+        pending.reserve(chunks > 0 ? chunks - 1 : 0);
+
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            pending.push_back(pool.Submit([&function, chunk] { function(chunk); }));
+        }
+
+        if (chunks > 0) {
+            function(0);
+        }
+
+        for (auto& chunk : pending) {
+            pool.Await(chunk);
+        }
+    }
+
+    void AppendPageNotice(const RowWindow&                    window,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator) {
+        if (window.Shown() == window.Count()) {
+            return;
+        }
+
+        const std::string message =
+            window.Shown() == 0
+                ? "No rows after " + std::to_string(window.Offset()) + " of " +
+                      std::to_string(window.Count())
+                : "Rows " + std::to_string(window.Offset() + 1) + "-" +
+                      std::to_string(window.Offset() + window.Shown()) + " of " +
+                      std::to_string(window.Count());
+
+        Value message_node = utils::ToJson(p({text(message)}), allocator);
+        utils::AppendChild(report, message_node, allocator);
+    }
+
+    void AppendConversionNotice(const ConversionService&            conversion,
+                                rapidjson::Value&                   report,
+                                rapidjson::Document::AllocatorType& allocator) {
+        const auto failed = conversion.FailedCurrencies();
+        if (failed.empty()) {
+            return;
+        }
+
+        std::string message = "No " + conversion.TargetCurrency() + " conversion rate for:";
+        for (const auto& currency : failed) {
+            message += " " + currency;
+        }
+
+        Value message_node = utils::ToJson(p({text(message)}), allocator);
+        utils::AppendChild(report, message_node, allocator);
+    }
+} // namespace services
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "services/ConversionService.h"
+#include "services/ReportTask.h"
+#include "services/ThreadPool.h"
+#include "structures/EquityTableSchema.h"
+#include "structures/PluginStructures.h"
+#include "structures/ReportOptions.h"
+#include "utils/RadixSort.h"
+
+namespace services {
+    // Rows per chunk below which the row order is computed on the calling thread
+    inline constexpr size_t parallel_sort_chunk = 32768;
+
+    // Page of the emitted rows selected by the request offset and limit
+    class RowWindow {
+    public:
+        RowWindow(size_t offset, size_t limit) : _offset(offset), _limit(limit) {}
+
+        // Counts an emitted row and tells whether it belongs to the page
+        bool Take() {
+            const size_t position = _count++;
+            return position >= _offset && position - _offset < _limit;
+        }
+
+        [[nodiscard]] size_t Offset() const { return _offset; }
+        [[nodiscard]] size_t Count() const { return _count; }
+        [[nodiscard]] size_t Shown() const {
+            return _count > _offset ? std::min(_limit, _count - _offset) : 0;
+        }
+
+    private:
+        size_t _offset;
+        size_t _limit;
+        size_t _count = 0;
+    };
+
+    // Thrown by the builders when the records of the range cannot be fetched, the caller
+    // replies with the message instead of a report missing the rows
+    class FetchError : public std::runtime_error {
+    public:
+        FetchError() : std::runtime_error("Equity records could not be fetched") {}
+    };
+
+    /**
+     * Equity records of [from, to] for the request group mask, without snapshot selection.
+     *
+     * With the intraday option the part of the range from the start of the current day is
+     * served by the live margin-level snapshot instead of the stored daily records. False when
+     * the stored records or the live snapshot could not be fetched.
+     */
+    bool FetchRangeRecords(const ReportOptions&       options,
+                           CServerInterface*          server,
+                           time_t                     from,
+                           time_t                     to,
+                           std::vector<EquityRecord>& records);
+
+    // Records of the request range with its snapshot selection; false when the task was
+    // cancelled, FetchError when the records could not be fetched
+    bool FetchEquities(const ReportOptions&       options,
+                       CServerInterface*          server,
+                       ReportTask&                task,
+                       std::vector<EquityRecord>& records);
+
+    // Table props shared by the report tables
+    void SetupReportTable(TableBuilder&      table_builder,
+                          const std::string& name,
+                          bool               compact_rows,
+                          const std::string& order_by,
+                          bool               is_descending);
+
+    std::vector<FilterOption> CreateGroupOptions(const std::vector<GroupRecord>& groups);
+
+    // Adds the converted money fields of the record to the total
+    void AccumulateTotal(Total& total, const EquityRecord& record, double multiplier);
+
+    JSONArray CreateTotalData(const Total& total);
+
+    // Tells which rows are shown when the page does not cover the whole table
+    void AppendPageNotice(const RowWindow&                    window,
+                          rapidjson::Value&                   report,
+                          rapidjson::Document::AllocatorType& allocator);
+
+    // Lists currencies without a conversion rate under the report content
+    void AppendConversionNotice(const ConversionService&            conversion,
+                                rapidjson::Value&                   report,
+                                rapidjson::Document::AllocatorType& allocator);
+
+    // Calls function(chunk) for every chunk, the calling thread takes the first one
+    void RunChunks(ThreadPool& pool, size_t chunks, const std::function<void(size_t)>& function);
+
+    // Requested order column when the schema has it, the fallback column otherwise
+    template <typename Schema>
+    std::string ResolveOrderColumn(const Schema&      schema,
+                                   const std::string& order_by,
+                                   const char*        fallback = "login") {
+        const bool is_known =
+            FindSchemaColumn(schema, order_by) < std::tuple_size_v<std::decay_t<Schema>>;
+        return is_known ? order_by : fallback;
+    }
+
+    /**
+     * Emission order of the rows by a schema column, as a permutation of row indices.
+     *
+     * Numbers are radix-sorted on order-preserving keys of the emitted (converted and
+     * truncated) values, text by the rank of the value among the distinct ones. Tables
+     * larger than a chunk compute keys and sort passes on the pool. Equal values keep
+     * their source order.
+     */
+    template <typename Schema, typename RowOf>
+    std::vector<uint32_t> SortSchemaRows(const Schema&      schema,
+                                         const std::string& column,
+                                         bool               is_descending,
+                                         size_t             count,
+                                         RowOf&&            row_of,
+                                         ThreadPool&        pool) {
+        const size_t position = FindSchemaColumn(schema, column);
+        const size_t chunks   = std::clamp<size_t>(count / parallel_sort_chunk, 1, pool.Size());
+
+        // Columns hold one type, so the first row tells whether text ranks are needed
+        const bool is_text =
+            count > 0 && std::holds_alternative<std::string>(
+                             SchemaColumnValue(schema, position, row_of(0)).value);
+
+        std::vector<uint64_t>    keys(count);
+        std::vector<std::string> texts(is_text ? count : 0);
+
+        RunChunks(pool, chunks, [&](size_t chunk) {
+            for (size_t i = count * chunk / chunks; i < count * (chunk + 1) / chunks; ++i) {
+                JSONValue value = SchemaColumnValue(schema, position, row_of(i));
+                if (auto* text = std::get_if<std::string>(&value.value); text && is_text) {
+                    texts[i] = std::move(*text);
+                } else if (const auto* number = std::get_if<double>(&value.value)) {
+                    keys[i] = utils::DoubleSortKey(*number);
+                } else if (const auto* flag = std::get_if<bool>(&value.value)) {
+                    keys[i] = *flag ? 1 : 0;
+                }
+            }
+        });
+
+        if (!texts.empty()) {
+            std::vector<std::string> distinct = texts;
+            std::sort(distinct.begin(), distinct.end());
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] = std::lower_bound(distinct.begin(), distinct.end(), texts[i]) -
+                          distinct.begin();
+            }
+        }
+
+        if (is_descending) {
+            for (auto& key : keys) {
+                key = ~key;
+            }
+        }
+
+        return utils::RadixSortKeys(keys, chunks, [&](size_t parts, auto&& function) {
+            RunChunks(pool, parts, function);
+        });
+    }
+} // namespace services
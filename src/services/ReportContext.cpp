@@ -0,0 +1,73 @@
+#include "ReportContext.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace services {
+    namespace {
+        std::mutex                               registry_mutex;
+        std::vector<std::weak_ptr<ReportContext>> registry;
+
+        template <typename T>
+        void ClearBuffer(std::vector<T>& buffer) {
+            if (buffer.capacity() > ReportContext::max_kept_rows) {
+                std::vector<T>().swap(buffer);
+            } else {
+                buffer.clear();
+            }
+        }
+    } // namespace
+
+    ReportContext::ReportContext() : table_builder("DailyEquityReportTable") {}
+
+    ReportContext& ReportContext::Acquire() {
+        thread_local std::shared_ptr<ReportContext> context;
+
+        if (!context) {
+            context = std::make_shared<ReportContext>();
+
+            std::lock_guard lock(registry_mutex);
+            std::erase_if(registry, [](const auto& weak) { return weak.expired(); });
+            registry.push_back(context);
+        }
+
+        context->Reset();
+        return *context;
+    }
+
+    void ReportContext::ReleaseAll() {
+        std::lock_guard lock(registry_mutex);
+
+        for (const auto& weak : registry) {
+            if (const auto context = weak.lock()) {
+                context->Release();
+            }
+        }
+
+        std::erase_if(registry, [](const auto& weak) { return weak.expired(); });
+    }
+
+    void ReportContext::Reset() {
+        ClearBuffer(equity_vector);
+        ClearBuffer(previous_vector);
+        ClearBuffer(group_vector);
+
+        const bool is_oversized = table_builder.RowCapacity() > max_kept_rows;
+        table_builder.Clear();
+        if (is_oversized) {
+            table_builder.ShrinkToFit();
+        }
+
+        totals_map.clear();
+    }
+
+    void ReportContext::Release() {
+        std::vector<EquityRecord>().swap(equity_vector);
+        std::vector<EquityRecord>().swap(previous_vector);
+        std::vector<GroupRecord>().swap(group_vector);
+        table_builder.Clear();
+        table_builder.ShrinkToFit();
+
+        std::unordered_map<std::string, Total>().swap(totals_map);
+    }
+} // namespace services
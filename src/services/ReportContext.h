@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Structures.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "structures/PluginStructures.h"
+
+namespace services {
+    /**
+     * Per-thread working set of CreateReport.
+     *
+     * Buffers are cleared between calls but keep their capacity, so a thread that
+     * repeatedly builds reports of a similar size stops hitting the heap for them. A buffer
+     * grown past max_kept_rows is freed instead, so one large report does not pin its
+     * memory on the thread. Only these buffers are reused; rows and JSON nodes are still
+     * allocated per report. Builders run on the calling thread or an async job's own
+     * thread, never on pool workers, so a thread builds one report at a time.
+     * All contexts are released by ReleaseAll() from DestroyReport().
+     */
+    class ReportContext {
+    public:
+        // Rows or records a buffer may keep capacity for between reports
+        static constexpr size_t max_kept_rows = size_t{1} << 18;
+
+        ReportContext();
+
+        ReportContext(const ReportContext&)            = delete;
+        ReportContext& operator=(const ReportContext&) = delete;
+
+        // Context of the calling thread, reset for a new report
+        static ReportContext& Acquire();
+
+        // Frees the buffers of every thread context. Must not race with CreateReport
+        static void ReleaseAll();
+
+        std::vector<EquityRecord> equity_vector;
+        std::vector<EquityRecord> previous_vector; // Base snapshot of comparison reports
+        std::vector<GroupRecord>  group_vector;
+        TableBuilder              table_builder;
+
+        std::unordered_map<std::string, Total> totals_map;
+
+    private:
+        void Reset();
+        void Release();
+    };
+} // namespace services
@@ -0,0 +1,144 @@
+#include "ReportJobs.h"
+
+#include "services/PluginRuntime.h"
+#include "services/ReportMetrics.h"
+#include "services/Reports.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Minimal progress change worth a state message
+        constexpr double progress_notify_step = 0.05;
+    } // namespace
+
+    ReportJob::ReportJob(uint64_t id, ReportOptions options, CServerInterface* server)
+        : _id(id), _options(std::move(options)), _server(server) {}
+
+    void ReportJob::SetProgress(double progress) {
+        if (progress - _sent_progress < progress_notify_step && progress < 1.0) {
+            return;
+        }
+        _sent_progress = progress;
+
+        Document state;
+        state.SetObject();
+        state.AddMember("job", _id, state.GetAllocator());
+        state.AddMember("state", "running", state.GetAllocator());
+        state.AddMember("progress", progress, state.GetAllocator());
+        Send(state);
+    }
+
+    void ReportJob::Run() {
+        ReportMetrics& metrics = ReportMetrics::Instance();
+        const auto     started = std::chrono::steady_clock::now();
+
+        RequestOutcome outcome = RequestOutcome::Done;
+        Document       payload;
+        payload.SetObject();
+        auto& allocator = payload.GetAllocator();
+        payload.AddMember("job", _id, allocator);
+
+        try {
+            Value report;
+            bool  is_built = false;
+            {
+                PhaseTimer timer(MetricPhase::Build);
+                is_built = BuildReport(_options, _server, *this, report, allocator);
+            }
+
+            if (is_built) {
+                Value result;
+                {
+                    PhaseTimer timer(MetricPhase::Response);
+                    CreateReportResponse(_options, report, result, allocator);
+                }
+                payload.AddMember("state", "done", allocator);
+                payload.AddMember("result", result, allocator);
+            } else {
+                outcome = RequestOutcome::Cancelled;
+                payload.AddMember("state", "cancelled", allocator);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: job " << _id << ": " << e.what()
+                      << std::endl;
+            outcome = RequestOutcome::Failed;
+            payload.AddMember("state", "failed", allocator);
+            payload.AddMember("error", Value(e.what(), allocator), allocator);
+        }
+
+        Send(payload);
+
+        metrics.RecordSize(MetricSize::ResponseBytes, allocator.Size());
+        metrics.CountRequest(outcome);
+        metrics.RecordLatency(MetricPhase::Total, std::chrono::steady_clock::now() - started);
+        metrics.DumpIfDue(_server);
+
+        _is_finished.store(true);
+    }
+
+    void ReportJob::Send(const rapidjson::Value& data) const {
+        try {
+            if (_options.manager_id >= 0) {
+                _server->SendToManager(_options.manager_id, data);
+            } else {
+                _server->SendState(data);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+    }
+
+    uint64_t ReportJobManager::Start(const ReportOptions& options, CServerInterface* server) {
+        const uint64_t id  = _next_id.fetch_add(1);
+        auto           job = std::make_shared<ReportJob>(id, options, server);
+
+        // The runtime is created with the requested pool size before the job uses it
+        PluginRuntime::Instance(options.threads);
+
+        // A job gets its own thread: on the pool, a worker waiting for a short chunk could
+        // pick up a whole report and run it nested on its stack
+        std::lock_guard lock(_mutex);
+        ReapFinished();
+        _entries.push_back({job, std::async(std::launch::async, [job] { job->Run(); })});
+
+        return id;
+    }
+
+    bool ReportJobManager::Cancel(uint64_t id) {
+        std::lock_guard lock(_mutex);
+        for (auto& entry : _entries) {
+            if (entry.job->Id() == id && !entry.job->IsFinished()) {
+                entry.job->Cancel();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ReportJobManager::Shutdown() {
+        std::list<Entry> entries;
+        {
+            std::lock_guard lock(_mutex);
+            entries.swap(_entries);
+        }
+
+        for (auto& entry : entries) {
+            entry.job->Cancel();
+        }
+        for (auto& entry : entries) {
+            if (entry.done.valid()) {
+                entry.done.wait();
+            }
+        }
+    }
+
+    void ReportJobManager::ReapFinished() {
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            if (it->job->IsFinished()) {
+                it = _entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+} // namespace services
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Report built on a background thread of its own.
+     *
+     * Progress and the final payload are pushed to the requesting manager through
+     * SendToManager, or to the plugin state through SendState when no manager is given.
+     */
+    class ReportJob final : public ReportTask {
+    public:
+        ReportJob(uint64_t id, ReportOptions options, CServerInterface* server);
+
+        [[nodiscard]] bool IsCancelled() const override { return _is_cancelled.load(); }
+
+        void SetProgress(double progress) override;
+
+        void Cancel() { _is_cancelled.store(true); }
+
+        void Run();
+
+        [[nodiscard]] uint64_t Id() const { return _id; }
+        [[nodiscard]] bool     IsFinished() const { return _is_finished.load(); }
+
+    private:
+        void Send(const rapidjson::Value& data) const;
+
+        uint64_t          _id;
+        ReportOptions     _options;
+        CServerInterface* _server;
+        std::atomic<bool> _is_cancelled{false};
+        std::atomic<bool> _is_finished{false};
+        double            _sent_progress = 0.0;
+    };
+
+    // Background report jobs, each on its own thread, shut down from DestroyReport()
+    class ReportJobManager {
+    public:
+        static uint64_t Start(const ReportOptions& options, CServerInterface* server);
+
+        static bool Cancel(uint64_t id);
+
+        // Cancels all jobs and waits for their workers
+        static void Shutdown();
+
+    private:
+        struct Entry {
+            std::shared_ptr<ReportJob> job;
+            std::future<void>          done;
+        };
+
+        static void ReapFinished();
+
+        static inline std::mutex            _mutex;
+        static inline std::list<Entry>      _entries;
+        static inline std::atomic<uint64_t> _next_id{1};
+    };
+} // namespace services
@@ -0,0 +1,230 @@
+#include "ReportMetrics.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "ast/Ast.hpp"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        // Label values in the order of the enums
+        constexpr std::array<const char*, MetricIndex(MetricPhase::Count)> phase_names = {
+            "total", "parse", "fetch", "rates", "build", "response"};
+        constexpr std::array<const char*, MetricIndex(MetricSize::Count)> size_names = {
+            "fetched_rows", "response_bytes"};
+        constexpr std::array<const char*, MetricIndex(MetricCache::Count)> cache_names = {
+            "intraday", "history", "refresh"};
+        constexpr std::array<const char*, MetricIndex(RequestOutcome::Count)> outcome_names = {
+            "done", "rejected", "cancelled", "failed"};
+
+        constexpr std::array<double, 4> quantiles = {0.5, 0.9, 0.99, 0.999};
+
+        std::string FormatNumber(double value, const char* format = "%.6g") {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), format, value);
+            return buffer;
+        }
+
+        double Milliseconds(uint64_t microseconds) {
+            return static_cast<double>(microseconds) / 1000.0;
+        }
+
+        void AppendSummary(std::string&                  out,
+                           const std::string&            name,
+                           const char*                   label,
+                           const char*                   label_value,
+                           const utils::AtomicHistogram& histogram,
+                           double                        scale) {
+            const std::string labels = std::string(label) + "=\"" + label_value + "\"";
+            for (const double quantile : quantiles) {
+                out += name + "{" + labels + ",quantile=\"" + FormatNumber(quantile) + "\"} " +
+                       FormatNumber(static_cast<double>(histogram.Quantile(quantile)) * scale) +
+                       "\n";
+            }
+            out += name + "_sum{" + labels + "} " +
+                   FormatNumber(static_cast<double>(histogram.Sum()) * scale) + "\n";
+            out += name + "_count{" + labels + "} " + std::to_string(histogram.Count()) + "\n";
+        }
+
+        void AppendHeader(std::string&       out,
+                          const std::string& name,
+                          const char*        type,
+                          const char*        help) {
+            out += "# HELP " + name + " " + help + "\n";
+            out += "# TYPE " + name + " " + type + "\n";
+        }
+    } // namespace
+
+    ReportMetrics& ReportMetrics::Instance() {
+        static ReportMetrics metrics;
+        return metrics;
+    }
+
+    ReportMetrics::ReportMetrics() {
+        if (const char* env = std::getenv("DAILY_EQUITY_METRICS_DUMP")) {
+            _dump_target = env;
+        }
+        if (const char* env = std::getenv("DAILY_EQUITY_METRICS_INTERVAL_S")) {
+            const long seconds = std::strtol(env, nullptr, 10);
+            if (seconds > 0) {
+                _dump_interval = std::chrono::seconds(seconds);
+            }
+        }
+    }
+
+    void ReportMetrics::RecordLatency(MetricPhase                         phase,
+                                      std::chrono::steady_clock::duration duration) {
+        const auto microseconds =
+            std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        _latencies[MetricIndex(phase)].Record(
+            static_cast<uint64_t>(std::max<int64_t>(microseconds, 0)));
+    }
+
+    void ReportMetrics::RecordSize(MetricSize size, uint64_t value) {
+        _sizes[MetricIndex(size)].Record(value);
+    }
+
+    void ReportMetrics::CountRequest(RequestOutcome outcome) {
+        _requests[MetricIndex(outcome)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ReportMetrics::CountCache(MetricCache cache, bool is_hit) {
+        auto& counters = is_hit ? _cache_hits : _cache_misses;
+        counters[MetricIndex(cache)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::string ReportMetrics::Exposition() const {
+        std::string out;
+
+        const std::string latency = "daily_equity_report_phase_seconds";
+        AppendHeader(out, latency, "summary", "Latency of CreateReport and its phases.");
+        for (size_t phase = 0; phase < _latencies.size(); ++phase) {
+            AppendSummary(out, latency, "phase", phase_names[phase], _latencies[phase], 1e-6);
+        }
+
+        const std::string size = "daily_equity_report_size";
+        AppendHeader(out, size, "summary", "Rows per fetch and bytes per reply.");
+        for (size_t index = 0; index < _sizes.size(); ++index) {
+            AppendSummary(out, size, "kind", size_names[index], _sizes[index], 1.0);
+        }
+
+        const std::string requests = "daily_equity_report_requests_total";
+        AppendHeader(out, requests, "counter", "Report requests by outcome.");
+        for (size_t outcome = 0; outcome < _requests.size(); ++outcome) {
+            out += requests + "{outcome=\"" + outcome_names[outcome] + "\"} " +
+                   std::to_string(_requests[outcome].load(std::memory_order_relaxed)) + "\n";
+        }
+
+        const std::string caches = "daily_equity_report_cache_lookups_total";
+        AppendHeader(out, caches, "counter", "Cache lookups by cache and result.");
+        for (size_t cache = 0; cache < _cache_hits.size(); ++cache) {
+            out += caches + "{cache=\"" + cache_names[cache] + "\",result=\"hit\"} " +
+                   std::to_string(_cache_hits[cache].load(std::memory_order_relaxed)) + "\n";
+            out += caches + "{cache=\"" + cache_names[cache] + "\",result=\"miss\"} " +
+                   std::to_string(_cache_misses[cache].load(std::memory_order_relaxed)) + "\n";
+        }
+
+        return out;
+    }
+
+    rapidjson::Value ReportMetrics::CreateNode(
+        rapidjson::Document::AllocatorType& allocator) const {
+        std::vector<Node> children = {h1({text("Daily Equity Report Metrics")}),
+                                      h2({text("Latency (ms)")})};
+
+        for (size_t phase = 0; phase < _latencies.size(); ++phase) {
+            const auto& histogram = _latencies[phase];
+
+            std::string line = std::string(phase_names[phase]) + ": " +
+                               std::to_string(histogram.Count()) + " calls";
+            for (const double quantile : quantiles) {
+                line += ", p" + FormatNumber(quantile * 100.0) + " " +
+                        FormatNumber(Milliseconds(histogram.Quantile(quantile)), "%.3f");
+            }
+            line += ", max " + FormatNumber(Milliseconds(histogram.Max()), "%.3f");
+            children.push_back(p({text(line)}));
+        }
+
+        children.push_back(h2({text("Sizes")}));
+        for (size_t index = 0; index < _sizes.size(); ++index) {
+            const auto&  histogram = _sizes[index];
+            const double mean =
+                histogram.Count() > 0
+                    ? static_cast<double>(histogram.Sum()) / static_cast<double>(histogram.Count())
+                    : 0.0;
+            children.push_back(p({text(std::string(size_names[index]) + ": mean " +
+                                       FormatNumber(mean, "%.0f") + ", p99 " +
+                                       std::to_string(histogram.Quantile(0.99)) + ", max " +
+                                       std::to_string(histogram.Max()))}));
+        }
+
+        children.push_back(h2({text("Requests")}));
+        std::string requests;
+        for (size_t outcome = 0; outcome < _requests.size(); ++outcome) {
+            requests += std::string(outcome == 0 ? "" : ", ") + outcome_names[outcome] + " " +
+                        std::to_string(_requests[outcome].load(std::memory_order_relaxed));
+        }
+        children.push_back(p({text(requests)}));
+
+        children.push_back(h2({text("Caches")}));
+        for (size_t cache = 0; cache < _cache_hits.size(); ++cache) {
+            const uint64_t hits     = _cache_hits[cache].load(std::memory_order_relaxed);
+            const uint64_t misses   = _cache_misses[cache].load(std::memory_order_relaxed);
+            const double   hit_rate = hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0;
+            children.push_back(p({text(std::string(cache_names[cache]) + ": " +
+                                       std::to_string(hits) + " hits, " +
+                                       std::to_string(misses) + " misses (" +
+                                       FormatNumber(hit_rate, "%.1f") + "%)")}));
+        }
+
+        return utils::ToJson(Column(std::move(children)), allocator);
+    }
+
+    void ReportMetrics::DumpIfDue(CServerInterface* server) {
+        if (_dump_target.empty()) {
+            return;
+        }
+
+        // One finishing call claims the slot, the others return at once
+        const auto now  = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto       next = _next_dump.load(std::memory_order_relaxed);
+        if (now < next ||
+            !_next_dump.compare_exchange_strong(
+                next,
+                now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          _dump_interval)
+                          .count(),
+                std::memory_order_relaxed)) {
+            return;
+        }
+
+        const std::string exposition = Exposition();
+
+        if (_dump_target == "logs") {
+            try {
+                server->LogsOut("info", exposition);
+            } catch (const std::exception& e) {
+                std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            }
+            return;
+        }
+
+        // Scrapers read the file at any time, so it is replaced whole
+        const std::string temporary = _dump_target + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << exposition;
+            if (!file) {
+                std::cerr << "[DailyEquityReportInterface]: cannot write metrics to " << temporary
+                          << std::endl;
+                return;
+            }
+        }
+        if (std::rename(temporary.c_str(), _dump_target.c_str()) != 0) {
+            std::cerr << "[DailyEquityReportInterface]: cannot replace " << _dump_target
+                      << std::endl;
+        }
+    }
+} // namespace services
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "utils/AtomicHistogram.h"
+
+namespace services {
+    // Timed parts of a report; Total covers the whole CreateReport call or job
+    enum class MetricPhase { Total, Parse, Fetch, Rates, Build, Response, Count };
+
+    // Sizes recorded per fetch or per reply
+    enum class MetricSize { FetchedRows, ResponseBytes, Count };
+
+    enum class MetricCache { Intraday, History, Refresh, Count };
+
+    enum class RequestOutcome { Done, Rejected, Cancelled, Failed, Count };
+
+    template <typename Enum>
+    constexpr size_t MetricIndex(Enum value) {
+        return static_cast<size_t>(value);
+    }
+
+    /**
+     * Latency, size and cache counters kept across all CreateReport invocations.
+     *
+     * Every update is lock-free, so reports running on many threads record into the same
+     * histograms. The values are read back by a "metrics" request and, when
+     * DAILY_EQUITY_METRICS_DUMP names a file or "logs", written in the Prometheus text format
+     * every DAILY_EQUITY_METRICS_INTERVAL_S seconds (60 by default) by the next call to finish.
+     */
+    class ReportMetrics {
+    public:
+        static ReportMetrics& Instance();
+
+        void RecordLatency(MetricPhase phase, std::chrono::steady_clock::duration duration);
+
+        void RecordSize(MetricSize size, uint64_t value);
+
+        void CountRequest(RequestOutcome outcome);
+
+        void CountCache(MetricCache cache, bool is_hit);
+
+        // Prometheus text exposition of all metrics
+        [[nodiscard]] std::string Exposition() const;
+
+        // Report content with the quantiles and counters
+        rapidjson::Value CreateNode(rapidjson::Document::AllocatorType& allocator) const;
+
+        // Writes the exposition to the configured target once the dump interval has passed
+        void DumpIfDue(CServerInterface* server);
+
+    private:
+        ReportMetrics();
+
+        std::array<utils::AtomicHistogram, MetricIndex(MetricPhase::Count)>   _latencies;
+        std::array<utils::AtomicHistogram, MetricIndex(MetricSize::Count)>    _sizes;
+        std::array<std::atomic<uint64_t>, MetricIndex(RequestOutcome::Count)> _requests{};
+        std::array<std::atomic<uint64_t>, MetricIndex(MetricCache::Count)>    _cache_hits{};
+        std::array<std::atomic<uint64_t>, MetricIndex(MetricCache::Count)>    _cache_misses{};
+
+        std::string                                 _dump_target; // File path or "logs"
+        std::chrono::seconds                        _dump_interval{60};
+        std::atomic<std::chrono::steady_clock::rep> _next_dump{0};
+    };
+
+    // Records the time from its construction to its destruction as one phase
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer(MetricPhase phase)
+            : _phase(phase), _started(std::chrono::steady_clock::now()) {}
+
+        ~PhaseTimer() {
+            ReportMetrics::Instance().RecordLatency(_phase,
+                                                    std::chrono::steady_clock::now() - _started);
+        }
+
+        PhaseTimer(const PhaseTimer&)            = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    private:
+        MetricPhase                           _phase;
+        std::chrono::steady_clock::time_point _started;
+    };
+} // namespace services
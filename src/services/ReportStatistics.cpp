@@ -0,0 +1,151 @@
+#include "ReportStatistics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ast/Ast.hpp"
+#include "services/ReportCommon.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr std::array<double, 4> quantiles = {0.1, 0.5, 0.9, 0.99};
+
+        std::string FormatNumber(double value) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+            return buffer;
+        }
+
+        std::string FormatQuantiles(const utils::LogHistogram& histogram) {
+            std::string line;
+            for (const double share : quantiles) {
+                const std::string name = "p" + std::to_string(static_cast<int>(share * 100));
+                line += (line.empty() ? "" : ", ") + name + " " +
+                        FormatNumber(histogram.Quantile(share));
+            }
+            return line;
+        }
+
+        std::string FormatBand(size_t band) {
+            const auto& bands = EquityStatistics::margin_bands;
+            const auto  from  = std::to_string(static_cast<int>(bands[band]));
+            return band + 1 < bands.size()
+                       ? from + "-" + std::to_string(static_cast<int>(bands[band + 1]))
+                       : from + "+";
+        }
+    } // namespace
+
+    MarginCallLevels CreateMarginCallLevels(const std::vector<GroupRecord>& groups) {
+        MarginCallLevels levels;
+        for (const auto& group : groups) {
+            if (group.margin_call > 0) {
+                levels.emplace(group.group, group.margin_call);
+            }
+        }
+        return levels;
+    }
+
+    void EquityStatistics::Add(const EquityRecord& record, const ConversionRate& rate) {
+        ++_accounts;
+
+        if (rate.is_resolved) {
+            _equities.Add(record.equity * rate.multiplier);
+        }
+
+        // The margin level is only defined while margin is in use
+        if (record.margin <= 0.0) {
+            return;
+        }
+
+        _margin_levels.Add(record.margin_level);
+
+        const auto band = std::upper_bound(margin_bands.begin(), margin_bands.end(),
+                                           record.margin_level) -
+                          margin_bands.begin();
+        ++_band_counts[band > 0 ? static_cast<size_t>(band) - 1 : 0];
+
+        const auto level = _margin_calls->find(record.group);
+        if (level != _margin_calls->end() && record.margin_level < level->second) {
+            ++_below_margin_call;
+        }
+    }
+
+    void EquityStatistics::Merge(const EquityStatistics& other) {
+        _margin_levels.Merge(other._margin_levels);
+        _equities.Merge(other._equities);
+        for (size_t band = 0; band < _band_counts.size(); ++band) {
+            _band_counts[band] += other._band_counts[band];
+        }
+        _accounts += other._accounts;
+        _below_margin_call += other._below_margin_call;
+    }
+
+    rapidjson::Value EquityStatistics::CreateNode(
+        const std::string&                  currency,
+        rapidjson::Document::AllocatorType& allocator) const {
+        const uint64_t with_margin = _margin_levels.Count();
+        const double   below_share =
+            with_margin > 0 ? 100.0 * static_cast<double>(_below_margin_call) / with_margin : 0.0;
+
+        JSONArray bands;
+        for (size_t band = 0; band < _band_counts.size(); ++band) {
+            bands.emplace_back(JSONObject{
+                {"band", FormatBand(band)},
+                {"accounts", static_cast<double>(_band_counts[band])},
+            });
+        }
+
+        const Node section = div({
+            h2({text("Statistics")}),
+            p({text("Accounts: " + std::to_string(_accounts) + ", with margin in use: " +
+                    std::to_string(with_margin) + ", below margin call: " +
+                    std::to_string(_below_margin_call) + " (" + FormatNumber(below_share) +
+                    "%)")}),
+            p({text("Margin level (%): " + FormatQuantiles(_margin_levels))}),
+            p({text("Equity (" + currency + "): " + FormatQuantiles(_equities) +
+                    "; top 1% of accounts hold " + FormatNumber(100.0 * _equities.TopShare(0.01)) +
+                    "%, top 10% hold " + FormatNumber(100.0 * _equities.TopShare(0.1)) +
+                    "% of the positive equity")}),
+            h3({text("Accounts by margin level (%)")}),
+            ResponsiveContainer(
+                {BarChart({CartesianGrid({}, {{"strokeDasharray", "3 3"}}),
+                           XAxis({}, {{"dataKey", "band"}}),
+                           YAxis({}, {{"allowDecimals", false}}),
+                           Tooltip(),
+                           Bar({}, {{"dataKey", "accounts"}, {"fill", "#1677ff"}})},
+                          {{"data", bands}})},
+                {{"width", "100%"}, {"height", 300.0}}),
+        });
+
+        return utils::ToJson(section, allocator);
+    }
+
+    EquityStatistics CollectStatistics(const std::vector<EquityRecord>& records,
+                                       const ConversionService&         conversion,
+                                       const MarginCallLevels&          margin_calls,
+                                       ThreadPool&                      pool) {
+        const size_t chunks = std::max<size_t>(
+            1, std::min(pool.Size() + 1, records.size() / parallel_sort_chunk));
+
+        std::vector<EquityStatistics> partials(chunks, EquityStatistics(margin_calls));
+
+        RunChunks(pool, chunks, [&](size_t chunk) {
+            const size_t begin = records.size() * chunk / chunks;
+            const size_t end   = records.size() * (chunk + 1) / chunks;
+
+            for (size_t index = begin; index < end; ++index) {
+                const ConversionRate& rate = conversion.Find(records[index]);
+                if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                    continue;
+                }
+                partials[chunk].Add(records[index], rate);
+            }
+        });
+
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            partials.front().Merge(partials[chunk]);
+        }
+        return partials.front();
+    }
+} // namespace services
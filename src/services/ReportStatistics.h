@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ConversionService.h"
+#include "services/ThreadPool.h"
+#include "utils/LogHistogram.h"
+
+namespace services {
+    // Margin call level by group name, groups without one are left out
+    using MarginCallLevels = std::unordered_map<std::string, int>;
+
+    MarginCallLevels CreateMarginCallLevels(const std::vector<GroupRecord>& groups);
+
+    /**
+     * Shape of the book: margin level and equity distributions and margin call exposure.
+     *
+     * Rows are added one at a time in constant memory, and statistics of separate chunks
+     * merge into the statistics of their union.
+     */
+    class EquityStatistics {
+    public:
+        // Lower bounds of the margin level bands of the chart, in percent
+        static constexpr std::array<double, 6> margin_bands = {0, 50, 100, 200, 500, 1000};
+
+        explicit EquityStatistics(const MarginCallLevels& margin_calls)
+            : _margin_calls(&margin_calls) {}
+
+        // Adds a shown row; the equity is only counted when the rate is resolved
+        void Add(const EquityRecord& record, const ConversionRate& rate);
+
+        void Merge(const EquityStatistics& other);
+
+        // Section with the quantiles, concentration and the margin level chart
+        rapidjson::Value CreateNode(const std::string&                  currency,
+                                    rapidjson::Document::AllocatorType& allocator) const;
+
+    private:
+        const MarginCallLevels*                   _margin_calls;
+        utils::LogHistogram                       _margin_levels; // Accounts with margin in use
+        utils::LogHistogram                       _equities;      // In the report currency
+        std::array<uint64_t, margin_bands.size()> _band_counts{};
+        uint64_t                                  _accounts          = 0;
+        uint64_t                                  _below_margin_call = 0;
+    };
+
+    // Statistics of the records kept by the rate policy, collected in chunks on the pool
+    EquityStatistics CollectStatistics(const std::vector<EquityRecord>& records,
+                                       const ConversionService&         conversion,
+                                       const MarginCallLevels&          margin_calls,
+                                       ThreadPool&                      pool);
+} // namespace services
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace services {
+    /**
+     * Cooperative control of a report build.
+     *
+     * The builder polls IsCancelled() at its checkpoints and reports progress in [0, 1].
+     * The default implementation is used by synchronous calls and never cancels.
+     */
+    class ReportTask {
+    public:
+        virtual ~ReportTask() = default;
+
+        [[nodiscard]] virtual bool IsCancelled() const { return false; }
+
+        virtual void SetProgress(double /*progress*/) {}
+    };
+} // namespace services
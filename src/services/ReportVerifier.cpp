@@ -0,0 +1,256 @@
+#include "ReportVerifier.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "services/ReportTask.h"
+#include "services/Reports.h"
+#include "utils/Compression.h"
+
+namespace services {
+    namespace {
+        std::string Canonical(const rapidjson::Value& value) {
+            rapidjson::StringBuffer                  buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            value.Accept(writer);
+            return {buffer.GetString(), buffer.GetSize()};
+        }
+
+        const rapidjson::Value* FindTableProps(const rapidjson::Value& content) {
+            if (!content.IsObject() || !content.HasMember("children")) {
+                return nullptr;
+            }
+
+            for (const auto& child : content["children"].GetArray()) {
+                if (child.IsObject() && child.HasMember("type") && child["type"] == "Table") {
+                    return &child["props"];
+                }
+            }
+            return nullptr;
+        }
+
+        utils::CompressionCodec CodecByName(const char* name) {
+            for (const auto codec : {utils::CompressionCodec::Zstd,
+                                     utils::CompressionCodec::Lz4,
+                                     utils::CompressionCodec::Deflate}) {
+                if (std::strcmp(utils::CompressionCodecName(codec), name) == 0) {
+                    return codec;
+                }
+            }
+            return utils::CompressionCodec::None;
+        }
+
+        // Plain table data: column keys and canonical rows
+        struct PlainData {
+            std::vector<std::string> columns;
+            std::vector<std::string> rows;
+            std::vector<double>      order_values; // Numeric values of the order column
+            std::vector<std::string> order_texts;  // Text values of the order column
+        };
+
+        bool ExpandData(const rapidjson::Value& props,
+                        PlainData*              plain,
+                        std::string*            error) {
+            const rapidjson::Value& data = props["data"];
+
+            // Encoded rows are decoded into a document of their own
+            rapidjson::Document decoded;
+            const rapidjson::Value* rows = data.HasMember("rows") ? &data["rows"] : nullptr;
+
+            if (data.HasMember("rowsBlob")) {
+                std::string compressed;
+                std::string text;
+                if (!utils::DecodeBase64(data["rowsBlob"].GetString(), &compressed) ||
+                    !utils::Decompress(
+                        compressed, CodecByName(data["rowsCodec"].GetString()), &text)) {
+                    *error = "rowsBlob cannot be decoded";
+                    return false;
+                }
+                if (decoded.Parse(text.c_str()).HasParseError() || !decoded.IsArray()) {
+                    *error = "rowsBlob is not a JSON array";
+                    return false;
+                }
+                rows = &decoded;
+            }
+
+            if (!rows || !rows->IsArray()) {
+                *error = "table has no rows";
+                return false;
+            }
+
+            const bool is_compact = data.HasMember("encoding") && data["encoding"] == "compact";
+            const rapidjson::Value& columns = is_compact ? data["columns"] : data["structure"];
+            for (const auto& column : columns.GetArray()) {
+                plain->columns.emplace_back(column.GetString());
+            }
+
+            const auto order_column = std::find(plain->columns.begin(),
+                                                plain->columns.end(),
+                                                props["orderBy"][0].GetString()) -
+                                      plain->columns.begin();
+
+            rapidjson::Document row_document;
+            auto&               row_allocator = row_document.GetAllocator();
+
+            for (const auto& source : rows->GetArray()) {
+                rapidjson::Value row(rapidjson::kArrayType);
+
+                if (!is_compact) {
+                    row.CopyFrom(source, row_allocator);
+                } else {
+                    rapidjson::SizeType position = 0;
+                    for (const auto& key : plain->columns) {
+                        const rapidjson::Value name(rapidjson::StringRef(key.c_str()));
+                        if (data["constants"].HasMember(name)) {
+                            row.PushBack(rapidjson::Value(data["constants"][name], row_allocator),
+                                         row_allocator);
+                            continue;
+                        }
+
+                        if (position >= source.Size()) {
+                            *error = "compact row is shorter than its structure";
+                            return false;
+                        }
+
+                        const rapidjson::Value& cell = source[position++];
+                        if (data["dictionaries"].HasMember(name)) {
+                            const auto& dictionary = data["dictionaries"][name];
+                            const auto  index = static_cast<rapidjson::SizeType>(cell.GetDouble());
+                            if (index >= dictionary.Size()) {
+                                *error = "dictionary index out of range";
+                                return false;
+                            }
+                            row.PushBack(rapidjson::Value(dictionary[index], row_allocator),
+                                         row_allocator);
+                        } else {
+                            row.PushBack(rapidjson::Value(cell, row_allocator), row_allocator);
+                        }
+                    }
+                }
+
+                if (static_cast<size_t>(order_column) < row.Size()) {
+                    const auto              column = static_cast<rapidjson::SizeType>(order_column);
+                    const rapidjson::Value& cell   = row[column];
+                    if (cell.IsNumber()) {
+                        plain->order_values.push_back(cell.GetDouble());
+                    } else if (cell.IsString()) {
+                        plain->order_texts.emplace_back(cell.GetString());
+                    }
+                }
+
+                plain->rows.push_back(Canonical(row));
+            }
+
+            return true;
+        }
+
+        template <typename T>
+        bool IsOrdered(const std::vector<T>& values, bool is_descending) {
+            return is_descending ? std::is_sorted(values.rbegin(), values.rend())
+                                 : std::is_sorted(values.begin(), values.end());
+        }
+
+        // Canonical content without the table data, which is compared row by row
+        std::string CanonicalFrame(const rapidjson::Value& content) {
+            rapidjson::Document frame;
+            frame.CopyFrom(content, frame.GetAllocator());
+
+            for (auto& child : frame["children"].GetArray()) {
+                if (child.IsObject() && child.HasMember("type") && child["type"] == "Table") {
+                    child["props"].RemoveMember("data");
+                }
+            }
+            return Canonical(frame);
+        }
+    } // namespace
+
+    rapidjson::Value VerifyReport(const ReportOptions&                options,
+                                  CServerInterface*                   server,
+                                  const rapidjson::Value&             report,
+                                  rapidjson::Document::AllocatorType& allocator) {
+        Value verification(kObjectType);
+
+        if (options.export_format != ExportFormat::None || options.is_refresh ||
+            !options.batch.empty() || options.mode == ReportMode::History || options.exposure ||
+            options.rollup) {
+            verification.AddMember("status", "skipped", allocator);
+            return verification;
+        }
+
+        ReportOptions reference_options  = options;
+        reference_options.compact_rows   = false;
+        reference_options.rows_codec     = utils::CompressionCodec::None;
+        reference_options.bounded_memory = false;
+
+        rapidjson::Document reference_document;
+        Value               reference;
+        ReportTask          task;
+        BuildReport(reference_options, server, task, reference, reference_document.GetAllocator());
+
+        std::string difference;
+        PlainData   checked_data;
+        PlainData   reference_data;
+
+        const Value* checked_props   = FindTableProps(report);
+        const Value* reference_props = FindTableProps(reference);
+
+        if (!checked_props || !reference_props) {
+            difference = "report has no table";
+        } else if (!ExpandData(*checked_props, &checked_data, &difference) ||
+                   !ExpandData(*reference_props, &reference_data, &difference)) {
+            // The difference is already described
+        } else if (CanonicalFrame(report) != CanonicalFrame(reference)) {
+            difference = "table props or content differ";
+        } else if (checked_data.columns != reference_data.columns) {
+            difference = "column keys differ";
+        } else if (checked_data.rows.size() != reference_data.rows.size()) {
+            difference = "row count differs";
+        } else {
+            // Bounded mode keeps the fetch order of all-snapshot rows
+            const bool is_ordered =
+                !options.bounded_memory || options.snapshot != SnapshotMode::All;
+
+            if (is_ordered) {
+                const auto mismatch = std::mismatch(checked_data.rows.begin(),
+                                                    checked_data.rows.end(),
+                                                    reference_data.rows.begin());
+                if (mismatch.first != checked_data.rows.end()) {
+                    difference = "row " +
+                                 std::to_string(mismatch.first - checked_data.rows.begin()) +
+                                 " differs: " + *mismatch.first + " / " + *mismatch.second;
+                }
+
+                const bool is_descending =
+                    std::strcmp((*checked_props)["orderBy"][1].GetString(), "DESC") == 0;
+                if (difference.empty() && (!IsOrdered(checked_data.order_values, is_descending) ||
+                                           !IsOrdered(checked_data.order_texts, is_descending))) {
+                    difference = "rows do not follow orderBy";
+                }
+            } else {
+                std::sort(checked_data.rows.begin(), checked_data.rows.end());
+                std::sort(reference_data.rows.begin(), reference_data.rows.end());
+                if (checked_data.rows != reference_data.rows) {
+                    difference = "row sets differ";
+                }
+            }
+        }
+
+        const char* status = difference.empty() ? "match" : "mismatch";
+        verification.AddMember("status", StringRef(status), allocator);
+        verification.AddMember(
+            "rows", static_cast<uint64_t>(checked_data.rows.size()), allocator);
+
+        if (!difference.empty()) {
+            std::cerr << "[DailyEquityReportInterface]: verification failed: " << difference
+                      << std::endl;
+            verification.AddMember("difference", Value(difference.c_str(), allocator), allocator);
+        }
+
+        return verification;
+    }
+} // namespace services
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Differential check of a built report against the reference path.
+     *
+     * Rebuilds the report from the same request with every output optimization off
+     * (plain rows, no codec, in-memory fetch), expands compact and encoded rows of the
+     * checked report back to plain rows and compares both as canonical JSON: table props,
+     * column keys, rows and the surrounding content. Rows must also follow the order the
+     * table announces. The outcome is returned as a {status, rows, ...} object.
+     */
+    rapidjson::Value VerifyReport(const ReportOptions&                options,
+                                  CServerInterface*                   server,
+                                  const rapidjson::Value&             report,
+                                  rapidjson::Document::AllocatorType& allocator);
+} // namespace services
@@ -0,0 +1,64 @@
+#include "Reports.h"
+
+#include "services/BatchReport.h"
+#include "services/BoundedReport.h"
+#include "services/DeltaReport.h"
+#include "services/EquityReport.h"
+#include "services/ExportReport.h"
+#include "services/HistoryReport.h"
+#include "services/RefreshReport.h"
+#include "services/RollupReport.h"
+#include "utils/Utils.h"
+
+namespace services {
+    bool BuildReport(const ReportOptions&                options,
+                     CServerInterface*                   server,
+                     ReportTask&                         task,
+                     rapidjson::Value&                   report,
+                     rapidjson::Document::AllocatorType& allocator) {
+        if (options.is_refresh) {
+            return BuildRefreshReport(options, server, task, report, allocator);
+        }
+        if (!options.batch.empty()) {
+            return BuildBatchReport(options, server, task, report, allocator);
+        }
+        if (options.export_format != ExportFormat::None) {
+            return BuildEquityExport(options, server, task, report, allocator);
+        }
+
+        switch (options.mode) {
+            case ReportMode::Delta:
+                return BuildDeltaReport(options, server, task, report, allocator);
+            case ReportMode::History:
+                return BuildHistoryReport(options, server, task, report, allocator);
+            case ReportMode::Table:
+            default:
+                if (options.rollup) {
+                    return BuildRollupReport(options, server, task, report, allocator);
+                }
+                if (options.bounded_memory) {
+                    return BuildBoundedEquityReport(options, server, task, report, allocator);
+                }
+                return BuildEquityReport(options, server, task, report, allocator);
+        }
+    }
+
+    void CreateReportResponse(const ReportOptions&                options,
+                              rapidjson::Value&                   report,
+                              rapidjson::Value&                   response,
+                              rapidjson::Document::AllocatorType& allocator) {
+        if (options.is_refresh) {
+            response.SetObject();
+            response.AddMember("refresh", report, allocator);
+            return;
+        }
+
+        if (options.export_format == ExportFormat::None) {
+            utils::CreateUI(report, response, allocator);
+            return;
+        }
+
+        response.SetObject();
+        response.AddMember("attachment", report, allocator);
+    }
+} // namespace services
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    // Builds the content node of the report selected by the request mode and format
+    bool BuildReport(const ReportOptions&                options,
+                     CServerInterface*                   server,
+                     ReportTask&                         task,
+                     rapidjson::Value&                   report,
+                     rapidjson::Document::AllocatorType& allocator);
+
+    // Wraps a built report into the response: the modal UI, an export attachment or a refresh
+    void CreateReportResponse(const ReportOptions&                options,
+                              rapidjson::Value&                   report,
+                              rapidjson::Value&                   response,
+                              rapidjson::Document::AllocatorType& allocator);
+} // namespace services
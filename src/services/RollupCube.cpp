@@ -0,0 +1,454 @@
+#include "RollupCube.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "services/ReportCommon.h"
+
+namespace services {
+    namespace {
+        constexpr time_t   day_seconds   = 86400;
+        constexpr uint32_t file_magic    = 0x43524544; // "DERC"
+        constexpr uint32_t file_version  = 2;
+        constexpr uint64_t max_file_days = 100000; // Sanity bound of a file's runs
+
+        uint64_t SeriesKey(uint32_t group, uint32_t currency) {
+            return static_cast<uint64_t>(group) << 32 | currency;
+        }
+
+        template <typename T>
+        void Write(std::ostream& out, const T& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void WriteString(std::ostream& out, const std::string& value) {
+            Write(out, static_cast<uint32_t>(value.size()));
+            out.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        template <typename T>
+        bool Read(std::istream& in, T& value) {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        bool ReadString(std::istream& in, std::string& value) {
+            uint32_t size = 0;
+            if (!Read(in, size) || size > 4096) {
+                return false;
+            }
+            value.resize(size);
+            return static_cast<bool>(in.read(value.data(), size));
+        }
+    } // namespace
+
+    void RollupSums::Add(const EquityRecord& record) {
+        for (size_t field = 0; field < rollup_fields.size(); ++field) {
+            values[field] += record.*rollup_fields[field];
+        }
+        ++records;
+    }
+
+    void RollupSums::Add(const RollupSums& sums, double multiplier) {
+        for (size_t field = 0; field < values.size(); ++field) {
+            values[field] += sums.values[field] * multiplier;
+        }
+        records += sums.records;
+    }
+
+    RollupSums RollupSums::operator-(const RollupSums& other) const {
+        RollupSums difference;
+        for (size_t field = 0; field < values.size(); ++field) {
+            difference.values[field] = values[field] - other.values[field];
+        }
+        difference.records = records - other.records;
+        return difference;
+    }
+
+    EquityRecord RollupSums::ToRecord(const std::string& group) const {
+        EquityRecord record{};
+        record.group = group;
+        for (size_t field = 0; field < rollup_fields.size(); ++field) {
+            record.*rollup_fields[field] = values[field];
+        }
+        return record;
+    }
+
+    RollupCube::RollupCube() {
+        if (const char* env = std::getenv("DAILY_EQUITY_ROLLUP_FILE")) {
+            _path = env;
+        }
+    }
+
+    bool RollupCube::Update(CServerInterface* server,
+                            ThreadPool&       pool,
+                            const ReportTask& task,
+                            time_t            first_day,
+                            time_t            last_day) {
+        std::vector<std::pair<time_t, size_t>> missing;
+        {
+            std::lock_guard update_lock(_update_mutex);
+            if (!_is_loaded) {
+                Load();
+                _is_loaded = true;
+            }
+            missing = MissingDays(first_day, last_day);
+        }
+
+        if (missing.empty()) {
+            return true;
+        }
+
+        std::vector<time_t> day_starts;
+        for (const auto& [gap_first_day, gap_days] : missing) {
+            for (size_t day = 0; day < gap_days; ++day) {
+                day_starts.push_back(gap_first_day + static_cast<time_t>(day) * day_seconds);
+            }
+        }
+
+        // The server is called without the update lock, so other rollups go on meanwhile
+        std::vector<DayTotals> fetched(day_starts.size());
+        std::atomic<bool>      is_failed{false};
+        RunChunks(pool, day_starts.size(), [&](size_t index) {
+            if (is_failed.load() || task.IsCancelled() ||
+                !FetchDay(server, day_starts[index], fetched[index])) {
+                is_failed.store(true);
+            }
+        });
+
+        if (is_failed.load()) {
+            return false;
+        }
+
+        // A concurrent update may have merged some of the days by now, only the rest is added
+        std::lock_guard update_lock(_update_mutex);
+        for (const auto& [gap_first_day, gap_days] : MissingDays(first_day, last_day)) {
+            const size_t offset = static_cast<size_t>(
+                std::lower_bound(day_starts.begin(), day_starts.end(), gap_first_day) -
+                day_starts.begin());
+
+            DaySums sums;
+            for (size_t day = 0; day < gap_days; ++day) {
+                for (const auto& [key, totals] : fetched[offset + day]) {
+                    auto& series = sums[key];
+                    series.resize(gap_days);
+                    series[day] = totals;
+                }
+            }
+            Merge(gap_first_day, gap_days, sums);
+        }
+
+        Save();
+        return true;
+    }
+
+    std::vector<RollupCube::Row> RollupCube::Query(const utils::GroupMask& mask,
+                                                   time_t                  first_day,
+                                                   time_t                  last_day) const {
+        std::shared_lock lock(_mutex);
+
+        std::vector<Row>                     rows;
+        std::unordered_map<uint64_t, size_t> row_index;
+
+        const utils::GroupBitset groups = mask.Select(_groups);
+        for (const auto& [run_first_day, run] : _runs) {
+            size_t begin = 0;
+            size_t end   = 0;
+            if (!Positions(run_first_day, run, first_day, last_day, &begin, &end)) {
+                continue;
+            }
+
+            for (const auto& series : run.series) {
+                if (!groups.Test(series.group)) {
+                    continue;
+                }
+
+                RollupSums sums = series.prefix[end] - series.prefix[begin];
+                if (sums.records == 0) {
+                    continue;
+                }
+
+                const auto [row, is_inserted] =
+                    row_index.emplace(SeriesKey(series.group, series.currency), rows.size());
+                if (is_inserted) {
+                    rows.push_back(
+                        {_groups[series.group], _currencies[series.currency], std::move(sums)});
+                } else {
+                    rows[row->second].sums.Add(sums);
+                }
+            }
+        }
+        return rows;
+    }
+
+    bool RollupCube::FetchDay(CServerInterface* server, time_t day_start, DayTotals& totals) {
+        std::vector<EquityRecord> records;
+        try {
+            if (server->GetAccountsEquitiesByGroup(
+                    day_start, day_start + day_seconds - 1, "*", &records) != RET_OK) {
+                return false;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+            return false;
+        }
+
+        for (const auto& record : records) {
+            totals[{record.group, record.currency}].Add(record);
+        }
+        return true;
+    }
+
+    std::vector<std::pair<time_t, size_t>> RollupCube::MissingDays(time_t first_day,
+                                                                   time_t last_day) const {
+        std::vector<std::pair<time_t, size_t>> missing;
+        time_t                                 cursor = first_day;
+
+        auto it = _runs.upper_bound(first_day);
+        if (it != _runs.begin()) {
+            --it;
+        }
+        for (; it != _runs.end() && it->first <= last_day; ++it) {
+            const time_t run_end = it->first + static_cast<time_t>(it->second.days) * day_seconds;
+            if (run_end <= cursor) {
+                continue;
+            }
+            if (it->first > cursor) {
+                missing.emplace_back(cursor,
+                                     static_cast<size_t>((it->first - cursor) / day_seconds));
+            }
+            cursor = run_end;
+        }
+        if (cursor <= last_day) {
+            missing.emplace_back(cursor,
+                                 static_cast<size_t>((last_day - cursor) / day_seconds) + 1);
+        }
+        return missing;
+    }
+
+    void RollupCube::Merge(time_t first_day, size_t days, const DaySums& sums) {
+        std::unique_lock lock(_mutex);
+
+        Run added;
+        added.days = days;
+        for (const auto& [key, day_sums] : sums) {
+            const uint32_t group    = Intern(_groups, _group_ids, key.first);
+            const uint32_t currency = Intern(_currencies, _currency_ids, key.second);
+
+            Series series{group, currency, std::vector<RollupSums>(days + 1)};
+            for (size_t day = 0; day < days; ++day) {
+                series.prefix[day + 1] = series.prefix[day];
+                if (day < day_sums.size()) {
+                    series.prefix[day + 1].Add(day_sums[day]);
+                }
+            }
+
+            added.series_index.emplace(SeriesKey(group, currency), added.series.size());
+            added.series.push_back(std::move(series));
+        }
+
+        // A run starting right after the added days is folded into them
+        const auto next = _runs.find(first_day + static_cast<time_t>(days) * day_seconds);
+        if (next != _runs.end()) {
+            Append(added, next->second);
+            _runs.erase(next);
+        }
+
+        // The added days extend a run ending right before them
+        auto previous = _runs.lower_bound(first_day);
+        if (previous != _runs.begin()) {
+            --previous;
+            const time_t previous_end =
+                previous->first + static_cast<time_t>(previous->second.days) * day_seconds;
+            if (previous_end == first_day) {
+                Append(previous->second, added);
+                return;
+            }
+        }
+        _runs.emplace(first_day, std::move(added));
+    }
+
+    void RollupCube::Append(Run& run, const Run& next) {
+        // Series first seen in next have no records on the days of run
+        for (const auto& series : next.series) {
+            const uint64_t key = SeriesKey(series.group, series.currency);
+            if (run.series_index.emplace(key, run.series.size()).second) {
+                run.series.push_back(
+                    {series.group, series.currency, std::vector<RollupSums>(run.days + 1)});
+            }
+        }
+
+        for (auto& series : run.series) {
+            const uint64_t   key     = SeriesKey(series.group, series.currency);
+            const auto       it      = next.series_index.find(key);
+            const RollupSums covered = series.prefix.back();
+
+            series.prefix.reserve(run.days + next.days + 1);
+            for (size_t day = 1; day <= next.days; ++day) {
+                series.prefix.push_back(covered);
+                if (it != next.series_index.end()) {
+                    series.prefix.back().Add(next.series[it->second].prefix[day]);
+                }
+            }
+        }
+        run.days += next.days;
+    }
+
+    uint32_t RollupCube::Intern(std::vector<std::string>&                  names,
+                                std::unordered_map<std::string, uint32_t>& ids,
+                                const std::string&                         name) {
+        const auto [it, is_inserted] = ids.emplace(name, static_cast<uint32_t>(names.size()));
+        if (is_inserted) {
+            names.push_back(name);
+        }
+        return it->second;
+    }
+
+    bool RollupCube::Positions(time_t     run_first_day,
+                               const Run& run,
+                               time_t     first_day,
+                               time_t     last_day,
+                               size_t*    begin,
+                               size_t*    end) {
+        const time_t run_last = run_first_day + static_cast<time_t>(run.days) * day_seconds - 1;
+        if (run.days == 0 || last_day < run_first_day || first_day > run_last) {
+            return false;
+        }
+
+        const time_t begin_day = std::max(first_day, run_first_day);
+        const time_t end_day   = std::min(last_day, run_last);
+        *begin                 = static_cast<size_t>((begin_day - run_first_day) / day_seconds);
+        *end                   = static_cast<size_t>((end_day - run_first_day) / day_seconds) + 1;
+        return true;
+    }
+
+    void RollupCube::Load() {
+        if (_path.empty()) {
+            return;
+        }
+
+        std::ifstream in(_path, std::ios::binary);
+        if (!in) {
+            return;
+        }
+
+        uint32_t magic       = 0;
+        uint32_t version     = 0;
+        uint32_t field_count = 0;
+        bool     is_valid    = Read(in, magic) && Read(in, version) && Read(in, field_count) &&
+                        magic == file_magic && version == file_version &&
+                        field_count == rollup_fields.size();
+
+        std::vector<std::string> groups;
+        std::vector<std::string> currencies;
+        for (auto* names : {&groups, &currencies}) {
+            uint32_t count = 0;
+            is_valid       = is_valid && Read(in, count);
+            for (uint32_t index = 0; is_valid && index < count; ++index) {
+                names->emplace_back();
+                is_valid = ReadString(in, names->back());
+            }
+        }
+
+        uint32_t              run_count    = 0;
+        uint64_t              total_days   = 0;
+        time_t                previous_end = 0;
+        std::map<time_t, Run> runs;
+        is_valid = is_valid && Read(in, run_count);
+        for (uint32_t run_index = 0; is_valid && run_index < run_count; ++run_index) {
+            int64_t  first_day    = 0;
+            uint64_t days         = 0;
+            uint32_t series_count = 0;
+            is_valid = Read(in, first_day) && Read(in, days) && Read(in, series_count) &&
+                       days > 0 && days <= max_file_days - total_days;
+            total_days += is_valid ? days : 0;
+
+            Run run;
+            run.days = static_cast<size_t>(days);
+            for (uint32_t index = 0; is_valid && index < series_count; ++index) {
+                Series& current = run.series.emplace_back();
+                is_valid = Read(in, current.group) && Read(in, current.currency) &&
+                           current.group < groups.size() && current.currency < currencies.size();
+
+                current.prefix.resize(is_valid ? days + 1 : 0);
+                for (auto& sums : current.prefix) {
+                    is_valid = is_valid && Read(in, sums.records) && Read(in, sums.values);
+                }
+                run.series_index.emplace(SeriesKey(current.group, current.currency), index);
+            }
+
+            // Runs are stored in order and apart, as Merge keeps them
+            const time_t run_first_day = static_cast<time_t>(first_day);
+            is_valid = is_valid && (runs.empty() || previous_end < run_first_day);
+            if (is_valid) {
+                previous_end = run_first_day + static_cast<time_t>(days) * day_seconds;
+                runs.emplace(run_first_day, std::move(run));
+            }
+        }
+
+        if (!is_valid) {
+            std::cerr << "[DailyEquityReportInterface]: ignoring malformed rollup file " << _path
+                      << std::endl;
+            return;
+        }
+
+        std::unique_lock lock(_mutex);
+        for (const auto& group : groups) {
+            Intern(_groups, _group_ids, group);
+        }
+        for (const auto& currency : currencies) {
+            Intern(_currencies, _currency_ids, currency);
+        }
+        _runs = std::move(runs);
+    }
+
+    void RollupCube::Save() const {
+        if (_path.empty()) {
+            return;
+        }
+
+        // Written aside and renamed, a crash never leaves a truncated cube behind
+        const std::string temporary = _path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            Write(out, file_magic);
+            Write(out, file_version);
+            Write(out, static_cast<uint32_t>(rollup_fields.size()));
+
+            for (const auto* names : {&_groups, &_currencies}) {
+                Write(out, static_cast<uint32_t>(names->size()));
+                for (const auto& name : *names) {
+                    WriteString(out, name);
+                }
+            }
+
+            Write(out, static_cast<uint32_t>(_runs.size()));
+            for (const auto& [first_day, run] : _runs) {
+                Write(out, static_cast<int64_t>(first_day));
+                Write(out, static_cast<uint64_t>(run.days));
+                Write(out, static_cast<uint32_t>(run.series.size()));
+                for (const auto& series : run.series) {
+                    Write(out, series.group);
+                    Write(out, series.currency);
+                    for (const auto& sums : series.prefix) {
+                        Write(out, sums.records);
+                        Write(out, sums.values);
+                    }
+                }
+            }
+
+            if (!out) {
+                std::cerr << "[DailyEquityReportInterface]: cannot write rollup file " << temporary
+                          << std::endl;
+                return;
+            }
+        }
+
+        if (std::rename(temporary.c_str(), _path.c_str()) != 0) {
+            std::cerr << "[DailyEquityReportInterface]: cannot replace " << _path << std::endl;
+        }
+    }
+} // namespace services
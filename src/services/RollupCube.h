@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Structures.h"
+#include "utils/GroupMask.h"
+
+namespace services {
+    class ReportTask;
+    class ThreadPool;
+
+    // Summed EquityRecord fields; margin_level is a ratio and is not summed
+    inline constexpr std::array<double EquityRecord::*, 9> rollup_fields = {
+        &EquityRecord::balance,
+        &EquityRecord::prevbalance,
+        &EquityRecord::credit,
+        &EquityRecord::equity,
+        &EquityRecord::profit,
+        &EquityRecord::storage,
+        &EquityRecord::commission,
+        &EquityRecord::margin,
+        &EquityRecord::margin_free,
+    };
+
+    // Field sums and record count of one group and currency over some days
+    struct RollupSums {
+        std::array<double, rollup_fields.size()> values{};
+        uint64_t                                 records = 0;
+
+        void Add(const EquityRecord& record);
+
+        // Adds the sums converted with the multiplier
+        void Add(const RollupSums& sums, double multiplier = 1.0);
+
+        [[nodiscard]] RollupSums operator-(const RollupSums& other) const;
+
+        // Record holding the sums in its fields, for the equity table columns
+        [[nodiscard]] EquityRecord ToRecord(const std::string& group) const;
+    };
+
+    /**
+     * Sums of the numeric EquityRecord fields per group, closed day and currency.
+     *
+     * The covered days form runs of consecutive days. In each run every (group, currency)
+     * series keeps prefix sums, so the sums of any covered range are one subtraction per run
+     * and series and a report over many days costs O(groups) instead of a pass over the
+     * accounts. Closed days never change: Update() fetches only the days of the range no run
+     * covers, one day per pool task for every group, and writes the cube to
+     * DAILY_EQUITY_ROLLUP_FILE when set so it survives restarts. Fetched days join the runs
+     * they touch; days between runs are never fetched unless a range asks for them.
+     */
+    class RollupCube {
+    public:
+        struct Row {
+            std::string group;
+            std::string currency;
+            RollupSums  sums;
+        };
+
+        RollupCube();
+
+        /**
+         * Extends the cube to cover the days [first_day, last_day], given as day starts of
+         * closed days. Returns false when a fetch failed or the task was cancelled; the cube
+         * is left as it was.
+         */
+        bool Update(CServerInterface* server,
+                    ThreadPool&       pool,
+                    const ReportTask& task,
+                    time_t            first_day,
+                    time_t            last_day);
+
+        // Sums of the covered days of [first_day, last_day] for the groups of the mask
+        [[nodiscard]] std::vector<Row> Query(const utils::GroupMask& mask,
+                                             time_t                  first_day,
+                                             time_t                  last_day) const;
+
+        // Calls visitor(row, day) with the sums of each covered day of the range
+        template <typename Visitor>
+        void ForEachDay(const utils::GroupMask& mask,
+                        time_t                  first_day,
+                        time_t                  last_day,
+                        Visitor&&               visitor) const;
+
+    private:
+        struct Series {
+            uint32_t                group;
+            uint32_t                currency;
+            std::vector<RollupSums> prefix; // prefix[k]: sums of the first k days of the run
+        };
+
+        // Consecutive covered days starting at the map key
+        struct Run {
+            size_t                               days = 0;
+            std::vector<Series>                  series;
+            std::unordered_map<uint64_t, size_t> series_index;
+        };
+
+        // Sums of one fetched day by group and currency name
+        using DayTotals = std::map<std::pair<std::string, std::string>, RollupSums>;
+
+        // Day sums of a run of fetched days by group and currency name
+        using DaySums = std::map<std::pair<std::string, std::string>, std::vector<RollupSums>>;
+
+        static bool FetchDay(CServerInterface* server, time_t day_start, DayTotals& totals);
+
+        // First day and day count of each gap of [first_day, last_day] no run covers
+        [[nodiscard]] std::vector<std::pair<time_t, size_t>> MissingDays(time_t first_day,
+                                                                         time_t last_day) const;
+
+        // Adds fetched days as a run, joined with the runs right before and after them
+        void Merge(time_t first_day, size_t days, const DaySums& sums);
+
+        // Appends the days of next, which start right after the days of run
+        static void Append(Run& run, const Run& next);
+
+        uint32_t Intern(std::vector<std::string>&                  names,
+                        std::unordered_map<std::string, uint32_t>& ids,
+                        const std::string&                         name);
+
+        // Day positions of the range in the run, false when they do not overlap
+        static bool Positions(time_t     run_first_day,
+                              const Run& run,
+                              time_t     first_day,
+                              time_t     last_day,
+                              size_t*    begin,
+                              size_t*    end);
+
+        void Load();
+        void Save() const;
+
+        std::string                               _path;
+        std::mutex                                _update_mutex; // Loading, merges and saves
+        mutable std::shared_mutex                 _mutex;        // Readers and the merge
+        bool                                      _is_loaded = false;
+        std::vector<std::string>                  _groups;
+        std::vector<std::string>                  _currencies;
+        std::unordered_map<std::string, uint32_t> _group_ids;
+        std::unordered_map<std::string, uint32_t> _currency_ids;
+        std::map<time_t, Run>                     _runs; // By first day, never adjacent
+    };
+
+    template <typename Visitor>
+    void RollupCube::ForEachDay(const utils::GroupMask& mask,
+                                time_t                  first_day,
+                                time_t                  last_day,
+                                Visitor&&               visitor) const {
+        std::shared_lock lock(_mutex);
+
+        const utils::GroupBitset groups = mask.Select(_groups);
+        for (const auto& [run_first_day, run] : _runs) {
+            size_t begin = 0;
+            size_t end   = 0;
+            if (!Positions(run_first_day, run, first_day, last_day, &begin, &end)) {
+                continue;
+            }
+
+            for (const auto& series : run.series) {
+                if (!groups.Test(series.group)) {
+                    continue;
+                }
+
+                Row row{_groups[series.group], _currencies[series.currency], {}};
+                for (size_t position = begin; position < end; ++position) {
+                    row.sums = series.prefix[position + 1] - series.prefix[position];
+                    if (row.sums.records > 0) {
+                        visitor(row, run_first_day + static_cast<time_t>(position) * 86400);
+                    }
+                }
+            }
+        }
+    }
+} // namespace services
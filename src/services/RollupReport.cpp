@@ -0,0 +1,212 @@
+#include "RollupReport.h"
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <unordered_set>
+
+#include "ast/Ast.hpp"
+#include "services/ConversionService.h"
+#include "services/PluginRuntime.h"
+#include "services/ReportCommon.h"
+#include "services/ReportContext.h"
+#include "services/RollupCube.h"
+#include "structures/RollupTableSchema.h"
+#include "utils/GroupMask.h"
+#include "utils/Utils.h"
+
+namespace services {
+    namespace {
+        constexpr time_t day_seconds = 86400;
+
+        // Converted sums by group and shown currency, in group order
+        using RollupRows = std::map<std::pair<std::string, std::string>, RollupSums>;
+
+        void AddRow(RollupRows&              rows,
+                    const ConversionService& conversion,
+                    const std::string&       group,
+                    const std::string&       currency,
+                    const RollupSums&        sums,
+                    time_t                   time) {
+            const ConversionRate& rate = conversion.Find(currency, time);
+            if (!rate.is_resolved && conversion.Policy() == RatePolicy::Skip) {
+                return;
+            }
+
+            // Sums without a rate keep their own currency in a row of their own
+            const std::string& shown = rate.is_resolved ? conversion.TargetCurrency() : currency;
+            rows[{group, shown}].Add(sums, rate.is_resolved ? rate.multiplier : 1.0);
+        }
+    } // namespace
+
+    bool BuildRollupReport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   report,
+                           rapidjson::Document::AllocatorType& allocator) {
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        PluginRuntime& runtime = PluginRuntime::Instance(options.threads);
+        RollupCube&    cube    = runtime.Rollup();
+
+        // Whole closed days come from the cube, partial edge days and today from the records
+        const time_t today_start = utils::DayStart(std::time(nullptr));
+        const time_t from_day    = utils::DayStart(options.from);
+        const time_t first_day   = from_day == options.from ? from_day : from_day + day_seconds;
+        const time_t last_day =
+            std::min(utils::DayStart(options.to + 1) - day_seconds, today_start - day_seconds);
+
+        const bool is_rolled_up =
+            first_day <= last_day && cube.Update(server, runtime.Pool(), task, first_day, last_day);
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        ReportContext& context      = ReportContext::Acquire();
+        auto&          records      = context.equity_vector;
+        auto&          group_vector = context.group_vector;
+
+        bool is_fetched = true;
+        if (!is_rolled_up) {
+            is_fetched = FetchRangeRecords(options, server, options.from, options.to, records);
+        } else {
+            if (options.from < first_day) {
+                is_fetched =
+                    FetchRangeRecords(options, server, options.from, first_day - 1, records);
+            }
+            if (is_fetched && last_day + day_seconds <= options.to) {
+                is_fetched = FetchRangeRecords(
+                    options, server, last_day + day_seconds, options.to, records);
+            }
+        }
+
+        try {
+            server->GetAllGroups(&group_vector);
+        } catch (const std::exception& e) {
+            std::cerr << "[DailyEquityReportInterface]: " << e.what() << std::endl;
+        }
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        if (!is_fetched) {
+            throw FetchError();
+        }
+        task.SetProgress(0.3);
+
+        const utils::GroupMask          mask(options.group_mask);
+        const std::vector<RollupCube::Row> cube_rows =
+            is_rolled_up ? cube.Query(mask, first_day, last_day) : std::vector<RollupCube::Row>{};
+
+        std::unordered_set<std::string> currencies;
+        for (const auto& row : cube_rows) {
+            currencies.insert(row.currency);
+        }
+        for (const auto& record : records) {
+            currencies.insert(record.currency);
+        }
+
+        ConversionService conversion(server, runtime, options);
+        conversion.Prefetch(currencies);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+        task.SetProgress(0.6);
+
+        RollupRows rows;
+        if (options.historical_rates) {
+            // Daily closes differ per day, so the days are converted one by one
+            cube.ForEachDay(mask, first_day, last_day, [&](const RollupCube::Row& row, time_t day) {
+                AddRow(rows, conversion, row.group, row.currency, row.sums, day);
+            });
+        } else {
+            for (const auto& row : cube_rows) {
+                AddRow(rows, conversion, row.group, row.currency, row.sums, last_day);
+            }
+        }
+        for (const auto& record : records) {
+            RollupSums sums;
+            sums.Add(record);
+            AddRow(rows, conversion, record.group, record.currency, sums, record.create_time);
+        }
+
+        std::vector<EquityRecord> row_records;
+        std::vector<std::string>  row_currencies;
+        std::vector<uint64_t>     row_counts;
+        row_records.reserve(rows.size());
+        row_currencies.reserve(rows.size());
+        row_counts.reserve(rows.size());
+        for (const auto& [key, sums] : rows) {
+            row_records.push_back(sums.ToRecord(key.first));
+            row_currencies.push_back(key.second);
+            row_counts.push_back(sums.records);
+        }
+
+        const auto row_view = [&](size_t index) {
+            return RollupRowView{{row_records[index], 1.0, row_currencies[index]},
+                                 row_counts[index]};
+        };
+
+        const std::string order_by =
+            ResolveOrderColumn(rollup_table_schema, options.order_by, "group");
+
+        TableBuilder& table_builder = context.table_builder;
+        SetupReportTable(table_builder,
+                         "DailyEquityRollupTable",
+                         options.compact_rows,
+                         order_by,
+                         options.order_descending);
+        table_builder.SetIdColumn("group");
+        AddSchemaColumns(table_builder, rollup_table_schema, CreateGroupOptions(group_vector));
+
+        const auto row_order = SortSchemaRows(rollup_table_schema,
+                                              order_by,
+                                              options.order_descending,
+                                              row_records.size(),
+                                              row_view,
+                                              runtime.Pool());
+
+        Total total{};
+        total.currency = conversion.TargetCurrency();
+
+        RowWindow window(options.row_offset, options.row_limit);
+        for (const uint32_t index : row_order) {
+            // Only converted rows are in the target currency and count towards the totals
+            if (row_currencies[index] == conversion.TargetCurrency()) {
+                AccumulateTotal(total, row_records[index], 1.0);
+            }
+            if (window.Take()) {
+                table_builder.AddRow(EncodeSchemaRow(rollup_table_schema, row_view(index)));
+            }
+        }
+
+        table_builder.SetTotalData(CreateTotalData(total));
+        utils::CompressTableRows(table_builder, options.rows_codec);
+
+        if (task.IsCancelled()) {
+            return false;
+        }
+
+        std::string source = "Account records only";
+        if (is_rolled_up) {
+            source = "Days " + utils::FormatTimestampToString(first_day, "%Y.%m.%d") + " to " +
+                     utils::FormatTimestampToString(last_day, "%Y.%m.%d") +
+                     " from the rollup, other times from account records";
+        }
+
+        report = utils::ToJson(
+            Column({h1({text("Daily Equity Rollup")}), p({text(source)})}), allocator);
+
+        Value table_node = utils::CreateTableNode(table_builder, allocator);
+        utils::AppendChild(report, table_node, allocator);
+
+        AppendPageNotice(window, report, allocator);
+        AppendConversionNotice(conversion, report, allocator);
+
+        task.SetProgress(1.0);
+        return true;
+    }
+} // namespace services
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <rapidjson/document.h>
+
+#include "Structures.h"
+#include "services/ReportTask.h"
+#include "structures/ReportOptions.h"
+
+namespace services {
+    /**
+     * Builds a table of totals per group from the runtime rollup cube.
+     *
+     * The whole closed days of the range are answered from the cube's prefix sums, after
+     * fetching the days it does not cover yet; only the partial first and last days and the
+     * current day are read as account records. Rows of a group are converted to the target
+     * currency and merged, rows without a rate follow the rate policy.
+     *
+     * Returns false when the task was cancelled at one of the checkpoints.
+     */
+    bool BuildRollupReport(const ReportOptions&                options,
+                           CServerInterface*                   server,
+                           ReportTask&                         task,
+                           rapidjson::Value&                   report,
+                           rapidjson::Document::AllocatorType& allocator);
+} // namespace services
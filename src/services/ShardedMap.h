@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace services {
+    /**
+     * Hash map split into independently locked shards, shared between concurrent reports.
+     * Readers of a shard take a shared lock, so lookups of hot keys do not serialize.
+     */
+    template <typename Key, typename Value, size_t Shards = 16, typename Hash = std::hash<Key>>
+    class ShardedMap {
+    public:
+        [[nodiscard]] std::optional<Value> Find(const Key& key) const {
+            const Shard&     shard = ShardFor(key);
+            std::shared_lock lock(shard.mutex);
+
+            const auto it = shard.map.find(key);
+            if (it == shard.map.end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        void Set(const Key& key, Value value) {
+            Shard&           shard = ShardFor(key);
+            std::unique_lock lock(shard.mutex);
+            shard.map.insert_or_assign(key, std::move(value));
+        }
+
+        // Applies the updater to the value under the shard lock, default-constructing it if absent
+        template <typename Updater>
+        void Update(const Key& key, Updater&& updater) {
+            Shard&           shard = ShardFor(key);
+            std::unique_lock lock(shard.mutex);
+            updater(shard.map[key]);
+        }
+
+        bool Erase(const Key& key) {
+            Shard&           shard = ShardFor(key);
+            std::unique_lock lock(shard.mutex);
+            return shard.map.erase(key) > 0;
+        }
+
+        // Removes every entry the predicate accepts
+        template <typename Predicate>
+        void EraseIf(Predicate&& predicate) {
+            for (auto& shard : _shards) {
+                std::unique_lock lock(shard.mutex);
+                std::erase_if(shard.map,
+                              [&](const auto& item) { return predicate(item.first, item.second); });
+            }
+        }
+
+        // Calls visitor(key, value) for every entry under the shard's shared lock
+        template <typename Visitor>
+        void ForEach(Visitor&& visitor) const {
+            for (const auto& shard : _shards) {
+                std::shared_lock lock(shard.mutex);
+                for (const auto& [key, value] : shard.map) {
+                    visitor(key, value);
+                }
+            }
+        }
+
+        void Clear() {
+            for (auto& shard : _shards) {
+                std::unique_lock lock(shard.mutex);
+                shard.map.clear();
+            }
+        }
+
+    private:
+        struct Shard {
+            mutable std::shared_mutex            mutex;
+            std::unordered_map<Key, Value, Hash> map;
+        };
+
+        Shard& ShardFor(const Key& key) { return _shards[Hash{}(key) % Shards]; }
+
+        const Shard& ShardFor(const Key& key) const { return _shards[Hash{}(key) % Shards]; }
+
+        std::array<Shard, Shards> _shards;
+    };
+} // namespace services
@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace services {
+    thread_local const ThreadPool* ThreadPool::current_pool  = nullptr;
+    thread_local size_t            ThreadPool::current_index = 0;
+
+    ThreadPool::ThreadPool(size_t threads) {
+        threads = std::max<size_t>(threads, 1);
+
+        _queues.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+
+        _threads.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            _threads.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(_sleep_mutex);
+            _is_stopping = true;
+        }
+        _wake.notify_all();
+
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::Push(Task task) {
+        const size_t index =
+            IsWorkerThread() ? current_index : _next_queue.fetch_add(1) % _queues.size();
+
+        {
+            std::lock_guard lock(_sleep_mutex);
+            _pending.fetch_add(1);
+        }
+
+        {
+            std::lock_guard lock(_queues[index]->mutex);
+            _queues[index]->tasks.push_back(std::move(task));
+        }
+
+        _wake.notify_one();
+    }
+
+    bool ThreadPool::TryPop(size_t index, Task& task) {
+        {
+            std::lock_guard lock(_queues[index]->mutex);
+            if (!_queues[index]->tasks.empty()) {
+                task = std::move(_queues[index]->tasks.back());
+                _queues[index]->tasks.pop_back();
+                _pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < _queues.size(); ++offset) {
+            Queue&          victim = *_queues[(index + offset) % _queues.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                _pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool ThreadPool::TryRunOne(size_t index) {
+        Task task;
+        if (!TryPop(index, task)) {
+            return false;
+        }
+
+        task();
+        return true;
+    }
+
+    void ThreadPool::WorkerLoop(size_t index) {
+        current_pool  = this;
+        current_index = index;
+
+        while (true) {
+            if (TryRunOne(index)) {
+                continue;
+            }
+
+            std::unique_lock lock(_sleep_mutex);
+            _wake.wait(lock, [this] { return _is_stopping || _pending.load() > 0; });
+
+            if (_is_stopping && _pending.load() == 0) {
+                return;
+            }
+        }
+    }
+} // namespace services
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace services {
+    /**
+     * Work-stealing thread pool.
+     *
+     * Every worker owns a deque: it takes its own tasks from the back and steals from the
+     * front of the others. Tasks submitted from a worker stay on that worker's deque.
+     * Await() lets a worker run queued tasks while it waits, so nested submissions cannot
+     * exhaust the pool.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&)            = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template <typename F>
+        auto Submit(F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+
+            auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+            auto result = task->get_future();
+            Push([task] { (*task)(); });
+
+            return result;
+        }
+
+        template <typename T>
+        T Await(std::future<T>& future) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!IsWorkerThread() || !TryRunOne(current_index)) {
+                    future.wait_for(std::chrono::milliseconds(1));
+                }
+            }
+            return future.get();
+        }
+
+        [[nodiscard]] size_t Size() const { return _threads.size(); }
+
+    private:
+        using Task = std::function<void()>;
+
+        struct Queue {
+            std::mutex       mutex;
+            std::deque<Task> tasks;
+        };
+
+        void Push(Task task);
+        bool TryPop(size_t index, Task& task);
+        bool TryRunOne(size_t index);
+        void WorkerLoop(size_t index);
+
+        [[nodiscard]] bool IsWorkerThread() const { return current_pool == this; }
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread>            _threads;
+        std::mutex                          _sleep_mutex;
+        std::condition_variable             _wake;
+        std::atomic<size_t>                 _pending{0};
+        std::atomic<size_t>                 _next_queue{0};
+        bool                                _is_stopping = false;
+
+        static thread_local const ThreadPool* current_pool;
+        static thread_local size_t            current_index;
+    };
+} // namespace services
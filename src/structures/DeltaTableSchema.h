@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+
+#include "structures/EquityTableSchema.h"
+
+// Per-login change between two snapshots, already converted
+struct DeltaRowView {
+    const EquityRecord& delta;
+    const std::string&  currency;
+    const char*         status; // "new", "closed" or empty for accounts present on both days
+};
+
+constexpr auto DeltaAccessor(double EquityRecord::* field) {
+    return [field](const DeltaRowView& row) -> JSONValue {
+        return utils::TruncateDouble(row.delta.*field, 2);
+    };
+}
+
+inline constexpr auto delta_table_schema = std::make_tuple(
+    MakeEquityColumn("login",
+                     "LOGIN",
+                     1,
+                     FilterType::Search,
+                     [](const DeltaRowView& row) -> JSONValue {
+                         return utils::TruncateDouble(row.delta.login, 0);
+                     }),
+    MakeEquityColumn("group",
+                     "GROUP",
+                     2,
+                     FilterType::Select,
+                     [](const DeltaRowView& row) -> JSONValue { return row.delta.group; }),
+    MakeEquityColumn("status",
+                     "STATUS",
+                     3,
+                     FilterType::Search,
+                     [](const DeltaRowView& row) -> JSONValue { return row.status; }),
+    MakeEquityColumn(
+        "balance", "BALANCE", 5, FilterType::Search, DeltaAccessor(&EquityRecord::balance)),
+    MakeEquityColumn("floating_pl",
+                     "FLOATING_PL",
+                     6,
+                     FilterType::Search,
+                     [](const DeltaRowView& row) -> JSONValue {
+                         return utils::TruncateDouble(row.delta.equity - row.delta.balance, 2);
+                     }),
+    MakeEquityColumn(
+        "credit", "CREDIT", 7, FilterType::Search, DeltaAccessor(&EquityRecord::credit)),
+    MakeEquityColumn(
+        "equity", "EQUITY", 8, FilterType::Search, DeltaAccessor(&EquityRecord::equity)),
+    MakeEquityColumn(
+        "profit", "AMOUNT", 9, FilterType::Search, DeltaAccessor(&EquityRecord::profit)),
+    MakeEquityColumn(
+        "storage", "SWAP", 10, FilterType::Search, DeltaAccessor(&EquityRecord::storage)),
+    MakeEquityColumn("commission",
+                     "COMMISSION",
+                     11,
+                     FilterType::Search,
+                     DeltaAccessor(&EquityRecord::commission)),
+    MakeEquityColumn(
+        "margin", "MARGIN", 12, FilterType::Search, DeltaAccessor(&EquityRecord::margin)),
+    MakeEquityColumn("margin_free",
+                     "MARGIN_FREE",
+                     13,
+                     FilterType::Search,
+                     DeltaAccessor(&EquityRecord::margin_free)),
+    MakeEquityColumn("margin_level",
+                     "MARGIN_LEVEL (%)",
+                     14,
+                     FilterType::Search,
+                     DeltaAccessor(&EquityRecord::margin_level)),
+    MakeEquityColumn("currency",
+                     "CURRENCY",
+                     15,
+                     FilterType::Search,
+                     [](const DeltaRowView& row) -> JSONValue { return row.currency; }));
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "Structures.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "utils/Utils.h"
+
+// Converted view of one EquityRecord, the input of every column accessor
+struct EquityRowView {
+    const EquityRecord& record;
+    double              multiplier;
+    const std::string&  currency;
+};
+
+// Column of a report table bound to its value accessor at compile time
+template <typename Accessor>
+struct EquityColumn {
+    std::string_view key;
+    std::string_view language_token;
+    double           order;
+    FilterType       filter;
+    Accessor         accessor;
+};
+
+template <typename Accessor>
+constexpr EquityColumn<Accessor> MakeEquityColumn(std::string_view key,
+                                                  std::string_view language_token,
+                                                  double           order,
+                                                  FilterType       filter,
+                                                  Accessor         accessor) {
+    return {key, language_token, order, filter, accessor};
+}
+
+constexpr auto MoneyAccessor(double EquityRecord::* field) {
+    return [field](const EquityRowView& row) -> JSONValue {
+        return utils::TruncateDouble(row.record.*field * row.multiplier, 2);
+    };
+}
+
+inline constexpr auto equity_table_schema = std::make_tuple(
+    MakeEquityColumn("login",
+                     "LOGIN",
+                     1,
+                     FilterType::Search,
+                     [](const EquityRowView& row) -> JSONValue {
+                         return utils::TruncateDouble(row.record.login, 0);
+                     }),
+    MakeEquityColumn("create_time",
+                     "CREATE_TIME",
+                     2,
+                     FilterType::DateTime,
+                     [](const EquityRowView& row) -> JSONValue {
+                         return utils::FormatTimestampToString(row.record.create_time);
+                     }),
+    MakeEquityColumn("group",
+                     "GROUP",
+                     3,
+                     FilterType::Select,
+                     [](const EquityRowView& row) -> JSONValue { return row.record.group; }),
+    MakeEquityColumn(
+        "balance", "BALANCE", 5, FilterType::Search, MoneyAccessor(&EquityRecord::balance)),
+    MakeEquityColumn("prevbalance",
+                     "PREV_BALANCE",
+                     6,
+                     FilterType::Search,
+                     MoneyAccessor(&EquityRecord::prevbalance)),
+    MakeEquityColumn("floating_pl",
+                     "FLOATING_PL",
+                     7,
+                     FilterType::Search,
+                     [](const EquityRowView& row) -> JSONValue {
+                         const double floating_pl = row.record.equity - row.record.balance;
+                         return utils::TruncateDouble(floating_pl * row.multiplier, 2);
+                     }),
+    MakeEquityColumn(
+        "credit", "CREDIT", 8, FilterType::Search, MoneyAccessor(&EquityRecord::credit)),
+    MakeEquityColumn(
+        "equity", "EQUITY", 9, FilterType::Search, MoneyAccessor(&EquityRecord::equity)),
+    MakeEquityColumn(
+        "profit", "AMOUNT", 10, FilterType::Search, MoneyAccessor(&EquityRecord::profit)),
+    MakeEquityColumn(
+        "storage", "SWAP", 11, FilterType::Search, MoneyAccessor(&EquityRecord::storage)),
+    MakeEquityColumn("commission",
+                     "COMMISSION",
+                     12,
+                     FilterType::Search,
+                     MoneyAccessor(&EquityRecord::commission)),
+    MakeEquityColumn(
+        "margin", "MARGIN", 13, FilterType::Search, MoneyAccessor(&EquityRecord::margin)),
+    MakeEquityColumn("margin_free",
+                     "MARGIN_FREE",
+                     14,
+                     FilterType::Search,
+                     MoneyAccessor(&EquityRecord::margin_free)),
+    MakeEquityColumn("margin_level",
+                     "MARGIN_LEVEL (%)",
+                     15,
+                     FilterType::Search,
+                     [](const EquityRowView& row) -> JSONValue {
+                         return utils::TruncateDouble(row.record.margin_level, 2);
+                     }),
+    MakeEquityColumn("currency",
+                     "CURRENCY",
+                     16,
+                     FilterType::Search,
+                     [](const EquityRowView& row) -> JSONValue { return row.currency; }));
+
+inline constexpr size_t equity_table_columns_count =
+    std::tuple_size_v<std::decay_t<decltype(equity_table_schema)>>;
+
+static_assert(equity_table_columns_count == 15, "equity table must keep its 15 columns");
+
+// Declares the schema columns in order; select filters receive the given options
+template <typename Schema>
+void AddSchemaColumns(TableBuilder&                    table_builder,
+                      const Schema&                    schema,
+                      const std::vector<FilterOption>& select_options) {
+    std::apply(
+        [&](const auto&... column) {
+            (
+                [&] {
+                    FilterConfig filter;
+                    filter.type = column.filter;
+                    if (column.filter == FilterType::Select) {
+                        filter.options = select_options;
+                    }
+                    table_builder.AddColumn({std::string(column.key),
+                                             std::string(column.language_token),
+                                             column.order,
+                                             filter});
+                }(),
+                ...);
+        },
+        schema);
+}
+
+// Encodes a row in schema column order
+template <typename Schema, typename RowView>
+JSONArray EncodeSchemaRow(const Schema& schema, const RowView& row) {
+    return std::apply(
+        [&](const auto&... column) {
+            JSONArray json_row;
+            json_row.reserve(sizeof...(column));
+            (json_row.push_back(column.accessor(row)), ...);
+            return json_row;
+        },
+        schema);
+}
+
+// Position of the column with the key, or the column count when the schema has none
+template <typename Schema>
+constexpr size_t FindSchemaColumn(const Schema& schema, std::string_view key) {
+    return std::apply(
+        [&](const auto&... column) {
+            size_t position = 0;
+            ((column.key == key ? false : (++position, true)) && ...);
+            return position;
+        },
+        schema);
+}
+
+// Value of the column at the given position for the row
+template <typename Schema, typename RowView>
+JSONValue SchemaColumnValue(const Schema& schema, size_t position, const RowView& row) {
+    return std::apply(
+        [&](const auto&... column) {
+            JSONValue value;
+            size_t    current = 0;
+            ((current++ == position ? (value = column.accessor(row), false) : true) && ...);
+            return value;
+        },
+        schema);
+}
+
+// Calls visitor(column, value) for every column of the row, in schema order
+template <typename Schema, typename RowView, typename Visitor>
+void VisitSchemaRow(const Schema& schema, const RowView& row, Visitor&& visitor) {
+    std::apply([&](const auto&... column) { (visitor(column, column.accessor(row)), ...); },
+               schema);
+}
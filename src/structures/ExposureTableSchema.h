@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "structures/EquityTableSchema.h"
+
+// Net volume of one symbol over the open trades of a login
+struct SymbolExposure {
+    std::string symbol;
+    double      net_lots = 0.0; // Buys positive, sells negative
+};
+
+// Open trades of one login, aggregated for the exposure columns
+struct LoginExposure {
+    int                         trades    = 0;
+    double                      buy_lots  = 0.0;
+    double                      sell_lots = 0.0;
+    double                      profit    = 0.0; // In the account currency
+    std::vector<SymbolExposure> symbols;
+};
+
+// Equity row joined with the open trades of its login, nullptr when it has none
+struct ExposureRowView : EquityRowView {
+    const LoginExposure* exposure;
+};
+
+constexpr auto ExposureLotsAccessor(double LoginExposure::* field) {
+    return [field](const ExposureRowView& row) -> JSONValue {
+        return row.exposure ? utils::TruncateDouble(row.exposure->*field, 2) : 0.0;
+    };
+}
+
+// Equity columns followed by the open trade columns
+inline constexpr auto exposure_table_schema = std::tuple_cat(
+    equity_table_schema,
+    std::make_tuple(
+        MakeEquityColumn("trades",
+                         "TRADES",
+                         17,
+                         FilterType::Search,
+                         [](const ExposureRowView& row) -> JSONValue {
+                             return row.exposure ? static_cast<double>(row.exposure->trades)
+                                                 : 0.0;
+                         }),
+        MakeEquityColumn("buy_lots",
+                         "BUY_LOTS",
+                         18,
+                         FilterType::Search,
+                         ExposureLotsAccessor(&LoginExposure::buy_lots)),
+        MakeEquityColumn("sell_lots",
+                         "SELL_LOTS",
+                         19,
+                         FilterType::Search,
+                         ExposureLotsAccessor(&LoginExposure::sell_lots)),
+        MakeEquityColumn("trades_profit",
+                         "TRADES_PROFIT",
+                         20,
+                         FilterType::Search,
+                         [](const ExposureRowView& row) -> JSONValue {
+                             return row.exposure ? utils::TruncateDouble(
+                                                       row.exposure->profit * row.multiplier, 2)
+                                                 : 0.0;
+                         }),
+        MakeEquityColumn("exposure",
+                         "EXPOSURE",
+                         21,
+                         FilterType::Search,
+                         [](const ExposureRowView& row) -> JSONValue {
+                             std::string exposure;
+                             if (!row.exposure) {
+                                 return exposure;
+                             }
+                             for (const auto& symbol : row.exposure->symbols) {
+                                 const double lots = utils::TruncateDouble(symbol.net_lots, 2);
+                                 char         volume[32];
+                                 std::snprintf(volume, sizeof(volume), "%+.2f", lots);
+                                 exposure += (exposure.empty() ? "" : ", ") + symbol.symbol +
+                                             " " + volume;
+                             }
+                             return exposure;
+                         })));
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "utils/Compression.h"
+
+// Records kept per login when the range spans several days
+enum class SnapshotMode {
+    All,    // Every daily record
+    Latest, // Last record of the range
+    First   // First record of the range
+};
+
+enum class ReportMode {
+    Table,  // Equity records of the range
+    Delta,  // Per-login changes between the days of "from" and "to"
+    History // Downsampled equity history of one login
+};
+
+// Delimited text returned as an attachment instead of the table UI
+enum class ExportFormat { None, Csv, Tsv };
+
+// Group and range of one table of a batch request
+struct ReportRange {
+    std::string group_mask;
+    time_t      from = 0;
+    time_t      to   = 0;
+};
+
+// Parsed CreateReport request
+struct ReportOptions {
+    ReportMode              mode          = ReportMode::Table;
+    ExportFormat            export_format = ExportFormat::None;
+    std::string             group_mask;
+    time_t                  from           = 0;
+    time_t                  to             = 0;
+    bool                    compact_rows   = false;
+    bool                    bounded_memory = false; // Day shards and spilled rows
+    bool                    verify         = false; // Compare with the reference path
+    bool                    intraday       = false; // Live margin levels for the current day
+    bool                    statistics     = false; // Distribution section under the table
+    bool                    exposure       = false; // Open trade columns joined by login
+    bool                    rollup         = false; // Group totals from the rollup cube
+    SnapshotMode            snapshot       = SnapshotMode::All;
+    std::string             rate_policy;
+    std::string             currency   = "USD"; // Target of conversions and totals
+    utils::CompressionCodec rows_codec = utils::CompressionCodec::None;
+    size_t                  threads    = 0; // Pool size, applied when the runtime is created
+
+    // "to" was left out and is the request time, so the range moves with every request
+    bool is_open_ended = false;
+
+    // Conversion at the daily close of each record's day instead of the spot rate
+    bool historical_rates = false;
+
+    // Row order, applied to the emitted rows and sent to the client table
+    std::string order_by         = "login";
+    bool        order_descending = true;
+
+    // Page of the ordered rows; totals still cover every row
+    size_t row_offset = 0;
+    size_t row_limit  = 0; // Set by the parser, never above the configured row cap
+
+    // History mode
+    int    login          = 0;
+    size_t history_points = 500; // Points kept after downsampling
+
+    // Tables built in one reply with shared fetches, rates and groups, empty for one table
+    std::vector<ReportRange> batch;
+
+    // Refresh replies with the rows changed since the client's version
+    bool     is_refresh    = false;
+    uint64_t refresh_since = 0;     // Version the client holds, 0 for none
+    bool     is_push       = false; // Reply through SendState/SendToManager
+
+    // Asynchronous jobs
+    bool     is_async   = false;
+    int      manager_id = -1;   // Receiver of the result, plugin state when negative
+    uint64_t cancel_job = 0;    // Job to cancel instead of building a report
+
+    // Reply with the latency and cache metrics of all calls instead of a report
+    bool metrics = false;
+};
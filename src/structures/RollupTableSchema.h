@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+
+#include "structures/EquityTableSchema.h"
+
+// Summed fields of one group held in a record, with the number of records summed
+struct RollupRowView : EquityRowView {
+    uint64_t records;
+};
+
+// Group totals: the summable equity columns with the record count after the group
+inline constexpr auto rollup_table_schema = std::make_tuple(
+    std::get<2>(equity_table_schema), // group
+    MakeEquityColumn("records",
+                     "RECORDS",
+                     4,
+                     FilterType::Search,
+                     [](const RollupRowView& row) -> JSONValue {
+                         return static_cast<double>(row.records);
+                     }),
+    std::get<3>(equity_table_schema),   // balance
+    std::get<4>(equity_table_schema),   // prevbalance
+    std::get<5>(equity_table_schema),   // floating_pl
+    std::get<6>(equity_table_schema),   // credit
+    std::get<7>(equity_table_schema),   // equity
+    std::get<8>(equity_table_schema),   // profit
+    std::get<9>(equity_table_schema),   // storage
+    std::get<10>(equity_table_schema),  // commission
+    std::get<11>(equity_table_schema),  // margin
+    std::get<12>(equity_table_schema),  // margin_free
+    std::get<14>(equity_table_schema)); // currency
+
+static_assert(FindSchemaColumn(rollup_table_schema, "margin_level") ==
+                  std::tuple_size_v<std::decay_t<decltype(rollup_table_schema)>>,
+              "margin levels are ratios and cannot be summed");
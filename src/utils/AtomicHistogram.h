@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace utils {
+    /**
+     * Histogram of unsigned values recorded concurrently without locks.
+     *
+     * Values below sub_buckets have a bucket each; above that every power of two is split into
+     * sub_buckets equal parts, as in an HDR histogram, so a quantile is reported at most 1/8
+     * above the recorded value at any magnitude. A record is a few relaxed atomic additions,
+     * and a reader running alongside writers sees a snapshot that is only approximately
+     * consistent between the buckets and the totals.
+     */
+    class AtomicHistogram {
+    public:
+        static constexpr unsigned sub_bucket_bits = 3;
+        static constexpr uint64_t sub_buckets     = uint64_t{1} << sub_bucket_bits;
+        static constexpr size_t   bucket_count    = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+        void Record(uint64_t value) {
+            _buckets[Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t max = _max.load(std::memory_order_relaxed);
+            while (value > max &&
+                   !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        [[nodiscard]] uint64_t Count() const { return _count.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t Sum() const { return _sum.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t Max() const { return _max.load(std::memory_order_relaxed); }
+
+        // Highest value of the bucket below which the given share of the values lies
+        [[nodiscard]] uint64_t Quantile(double share) const {
+            std::array<uint64_t, bucket_count> counts;
+            uint64_t                           total = 0;
+            for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                counts[bucket] = _buckets[bucket].load(std::memory_order_relaxed);
+                total += counts[bucket];
+            }
+            if (total == 0) {
+                return 0;
+            }
+
+            const auto rank =
+                static_cast<uint64_t>(std::clamp(share, 0.0, 1.0) * static_cast<double>(total - 1));
+
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                seen += counts[bucket];
+                if (seen > rank) {
+                    return std::min(UpperBound(bucket), Max());
+                }
+            }
+            return Max();
+        }
+
+    private:
+        static size_t Bucket(uint64_t value) {
+            if (value < sub_buckets) {
+                return static_cast<size_t>(value);
+            }
+
+            const unsigned octave = static_cast<unsigned>(std::bit_width(value)) - 1;
+            const uint64_t sub    = (value >> (octave - sub_bucket_bits)) & (sub_buckets - 1);
+            return static_cast<size_t>((octave - sub_bucket_bits + 1) * sub_buckets + sub);
+        }
+
+        static uint64_t UpperBound(size_t bucket) {
+            if (bucket < sub_buckets) {
+                return bucket;
+            }
+
+            const unsigned shift = static_cast<unsigned>(bucket / sub_buckets) - 1;
+            const uint64_t lower = (sub_buckets + bucket % sub_buckets) << shift;
+            return lower + ((uint64_t{1} << shift) - 1);
+        }
+
+        std::array<std::atomic<uint64_t>, bucket_count> _buckets{};
+        std::atomic<uint64_t>                           _count{0};
+        std::atomic<uint64_t>                           _sum{0};
+        std::atomic<uint64_t>                           _max{0};
+    };
+} // namespace utils
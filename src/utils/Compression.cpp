@@ -0,0 +1,288 @@
+#include "Compression.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#ifdef REPORT_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef REPORT_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
+#ifdef REPORT_WITH_DEFLATE
+#include <zlib.h>
+#endif
+
+namespace utils {
+    namespace {
+        bool IsCodecSupported(const CompressionCodec& codec) {
+            switch (codec) {
+#ifdef REPORT_WITH_ZSTD
+                case CompressionCodec::Zstd: return true;
+#endif
+#ifdef REPORT_WITH_LZ4
+                case CompressionCodec::Lz4: return true;
+#endif
+#ifdef REPORT_WITH_DEFLATE
+                case CompressionCodec::Deflate: return true;
+#endif
+                default: return false;
+            }
+        }
+
+        CompressionCodec ParseCompressionCodec(const char* name) {
+            if (std::strcmp(name, "zstd") == 0) {
+                return CompressionCodec::Zstd;
+            }
+            if (std::strcmp(name, "lz4") == 0) {
+                return CompressionCodec::Lz4;
+            }
+            if (std::strcmp(name, "deflate") == 0) {
+                return CompressionCodec::Deflate;
+            }
+            return CompressionCodec::None;
+        }
+    } // namespace
+
+    CompressionCodec SelectCompressionCodec(const rapidjson::Value& accepted) {
+        if (!accepted.IsArray()) {
+            return CompressionCodec::None;
+        }
+
+        for (const auto& name : accepted.GetArray()) {
+            if (!name.IsString()) {
+                continue;
+            }
+
+            const CompressionCodec codec = ParseCompressionCodec(name.GetString());
+            if (IsCodecSupported(codec)) {
+                return codec;
+            }
+        }
+
+        return CompressionCodec::None;
+    }
+
+    const char* CompressionCodecName(const CompressionCodec& codec) {
+        switch (codec) {
+            case CompressionCodec::Zstd: return "zstd";
+            case CompressionCodec::Lz4: return "lz4";
+            case CompressionCodec::Deflate: return "deflate";
+            case CompressionCodec::None: return "none";
+        }
+        return "none";
+    }
+
+    bool Compress(const std::string& input, const CompressionCodec& codec, std::string* output) {
+        switch (codec) {
+#ifdef REPORT_WITH_ZSTD
+            case CompressionCodec::Zstd: {
+                output->resize(ZSTD_compressBound(input.size()));
+                const size_t size =
+                    ZSTD_compress(output->data(), output->size(), input.data(), input.size(), 3);
+                if (ZSTD_isError(size)) {
+                    return false;
+                }
+                output->resize(size);
+                return true;
+            }
+#endif
+#ifdef REPORT_WITH_LZ4
+            case CompressionCodec::Lz4: {
+                output->resize(LZ4F_compressFrameBound(input.size(), nullptr));
+                const size_t size = LZ4F_compressFrame(
+                    output->data(), output->size(), input.data(), input.size(), nullptr);
+                if (LZ4F_isError(size)) {
+                    return false;
+                }
+                output->resize(size);
+                return true;
+            }
+#endif
+#ifdef REPORT_WITH_DEFLATE
+            case CompressionCodec::Deflate: {
+                uLongf size = compressBound(input.size());
+                output->resize(size);
+                if (compress2(reinterpret_cast<Bytef*>(output->data()),
+                              &size,
+                              reinterpret_cast<const Bytef*>(input.data()),
+                              input.size(),
+                              Z_DEFAULT_COMPRESSION) != Z_OK) {
+                    return false;
+                }
+                output->resize(size);
+                return true;
+            }
+#endif
+            default: return false;
+        }
+    }
+
+    bool Decompress(const std::string& input, const CompressionCodec& codec, std::string* output) {
+        switch (codec) {
+#ifdef REPORT_WITH_ZSTD
+            case CompressionCodec::Zstd: {
+                const unsigned long long size =
+                    ZSTD_getFrameContentSize(input.data(), input.size());
+                if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN) {
+                    return false;
+                }
+                output->resize(size);
+                const size_t result =
+                    ZSTD_decompress(output->data(), output->size(), input.data(), input.size());
+                return !ZSTD_isError(result) && result == size;
+            }
+#endif
+#ifdef REPORT_WITH_LZ4
+            case CompressionCodec::Lz4: {
+                LZ4F_dctx* context = nullptr;
+                if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION))) {
+                    return false;
+                }
+
+                output->clear();
+                char   buffer[64 * 1024];
+                size_t offset = 0;
+                size_t hint   = 1;
+                while (offset < input.size() && hint != 0) {
+                    size_t written = sizeof(buffer);
+                    size_t read    = input.size() - offset;
+                    hint = LZ4F_decompress(
+                        context, buffer, &written, input.data() + offset, &read, nullptr);
+                    if (LZ4F_isError(hint)) {
+                        break;
+                    }
+                    output->append(buffer, written);
+                    offset += read;
+                }
+
+                LZ4F_freeDecompressionContext(context);
+                return hint == 0;
+            }
+#endif
+#ifdef REPORT_WITH_DEFLATE
+            case CompressionCodec::Deflate: {
+                z_stream stream{};
+                if (inflateInit(&stream) != Z_OK) {
+                    return false;
+                }
+
+                stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream.avail_in = static_cast<uInt>(input.size());
+
+                output->clear();
+                char buffer[64 * 1024];
+                int  result = Z_OK;
+                while (result == Z_OK) {
+                    stream.next_out  = reinterpret_cast<Bytef*>(buffer);
+                    stream.avail_out = sizeof(buffer);
+                    result           = inflate(&stream, Z_NO_FLUSH);
+                    output->append(buffer, sizeof(buffer) - stream.avail_out);
+                }
+
+                inflateEnd(&stream);
+                return result == Z_STREAM_END;
+            }
+#endif
+            default: return false;
+        }
+    }
+
+    std::string EncodeBase64(const std::string& input) {
+        static constexpr char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string encoded;
+        encoded.reserve((input.size() + 2) / 3 * 4);
+
+        size_t i = 0;
+        for (; i + 2 < input.size(); i += 3) {
+            const uint32_t chunk = static_cast<uint8_t>(input[i]) << 16 |
+                                   static_cast<uint8_t>(input[i + 1]) << 8 |
+                                   static_cast<uint8_t>(input[i + 2]);
+            encoded.push_back(alphabet[chunk >> 18 & 0x3F]);
+            encoded.push_back(alphabet[chunk >> 12 & 0x3F]);
+            encoded.push_back(alphabet[chunk >> 6 & 0x3F]);
+            encoded.push_back(alphabet[chunk & 0x3F]);
+        }
+
+        if (i < input.size()) {
+            uint32_t chunk = static_cast<uint8_t>(input[i]) << 16;
+            if (i + 1 < input.size()) {
+                chunk |= static_cast<uint8_t>(input[i + 1]) << 8;
+            }
+            encoded.push_back(alphabet[chunk >> 18 & 0x3F]);
+            encoded.push_back(alphabet[chunk >> 12 & 0x3F]);
+            encoded.push_back(i + 1 < input.size() ? alphabet[chunk >> 6 & 0x3F] : '=');
+            encoded.push_back('=');
+        }
+
+        return encoded;
+    }
+
+    bool DecodeBase64(const std::string& input, std::string* output) {
+        static constexpr auto digits = [] {
+            std::array<int8_t, 256> table{};
+            table.fill(-1);
+            const char alphabet[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int8_t i = 0; i < 64; ++i) {
+                table[static_cast<uint8_t>(alphabet[i])] = i;
+            }
+            return table;
+        }();
+
+        output->clear();
+        output->reserve(input.size() / 4 * 3);
+
+        uint32_t chunk = 0;
+        int      bits  = 0;
+        for (const char c : input) {
+            if (c == '=') {
+                break;
+            }
+
+            const int8_t digit = digits[static_cast<uint8_t>(c)];
+            if (digit < 0) {
+                return false;
+            }
+
+            chunk = chunk << 6 | static_cast<uint32_t>(digit);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                output->push_back(static_cast<char>(chunk >> bits & 0xFF));
+            }
+        }
+
+        return true;
+    }
+
+    bool CompressTableRows(TableBuilder& table_builder, const CompressionCodec& codec) {
+        if (codec == CompressionCodec::None) {
+            return false;
+        }
+
+        rapidjson::StringBuffer             buffer;
+        rapidjson::Writer<StringBuffer>     writer(buffer);
+        table_builder.AcceptRows(writer);
+
+        std::string compressed;
+        if (!Compress({buffer.GetString(), buffer.GetSize()}, codec, &compressed)) {
+            std::cerr << "[DailyEquityReportInterface]: failed to compress rows with "
+                      << CompressionCodecName(codec) << std::endl;
+            return false;
+        }
+
+        table_builder.SetEncodedRows(CompressionCodecName(codec), EncodeBase64(compressed));
+
+        return true;
+    }
+} // namespace utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include <rapidjson/document.h>
+
+namespace utils {
+    enum class CompressionCodec { None, Zstd, Lz4, Deflate };
+
+    // Picks the first codec from the client's "accept_encoding" list that this build supports
+    CompressionCodec SelectCompressionCodec(const rapidjson::Value& accepted);
+
+    const char* CompressionCodecName(const CompressionCodec& codec);
+
+    bool Compress(const std::string& input, const CompressionCodec& codec, std::string* output);
+
+    bool Decompress(const std::string& input, const CompressionCodec& codec, std::string* output);
+
+    std::string EncodeBase64(const std::string& input);
+
+    bool DecodeBase64(const std::string& input, std::string* output);
+
+    // Replaces data.rows of the table with a compressed, base64 encoded rowsBlob
+    bool CompressTableRows(TableBuilder& table_builder, const CompressionCodec& codec);
+} // namespace utils
@@ -0,0 +1,85 @@
+#include "CsvWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace utils {
+    CsvWriter::CsvWriter(char separator, Sink sink, size_t chunk_size)
+        : _separator(separator), _sink(std::move(sink)), _chunk_size(chunk_size) {
+        _chunk.reserve(_chunk_size);
+    }
+
+    void CsvWriter::Field(std::string_view text) {
+        Separate();
+
+        if (_separator != ',') {
+            const char specials[] = {_separator, '\n', '\r', '\0'};
+            if (text.find_first_of(specials) == std::string_view::npos) {
+                Append(text);
+                return;
+            }
+
+            for (const char c : text) {
+                const bool is_special = c == _separator || c == '\n' || c == '\r';
+                Append(is_special ? std::string_view(" ") : std::string_view(&c, 1));
+            }
+            return;
+        }
+
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            Append(text);
+            return;
+        }
+
+        Append("\"");
+        for (size_t begin = 0; begin < text.size();) {
+            const size_t quote = std::min(text.find('"', begin), text.size());
+            Append(text.substr(begin, quote - begin));
+            if (quote < text.size()) {
+                Append("\"\"");
+            }
+            begin = quote + 1;
+        }
+        Append("\"");
+    }
+
+    void CsvWriter::Field(double value) {
+        Separate();
+
+        if (!std::isfinite(value)) {
+            return;
+        }
+
+        // Shortest text that reads back as the same double: 1001 rather than 1001.0
+        char       buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        Append(std::string_view(buffer, result.ptr - buffer));
+    }
+
+    void CsvWriter::EndRow() {
+        Append("\r\n");
+        _is_row_start = true;
+    }
+
+    void CsvWriter::Flush() {
+        if (!_chunk.empty()) {
+            _sink(_chunk);
+            _chunk.clear();
+        }
+    }
+
+    void CsvWriter::Separate() {
+        if (!_is_row_start) {
+            Append(std::string_view(&_separator, 1));
+        }
+        _is_row_start = false;
+    }
+
+    void CsvWriter::Append(std::string_view text) {
+        if (_chunk.size() + text.size() > _chunk_size) {
+            Flush();
+        }
+        _chunk.append(text);
+    }
+} // namespace utils
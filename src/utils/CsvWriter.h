@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace utils {
+    /**
+     * Delimited text writer that hands its output to a sink in fixed-size chunks.
+     *
+     * With ',' fields are quoted as in RFC 4180 when needed; with any other separator
+     * (TSV) separators and line breaks inside a field are replaced with spaces.
+     */
+    class CsvWriter {
+    public:
+        using Sink = std::function<void(std::string_view chunk)>;
+
+        static constexpr size_t default_chunk_size = 64 * 1024;
+
+        CsvWriter(char separator, Sink sink, size_t chunk_size = default_chunk_size);
+
+        void Field(std::string_view text);
+        void Field(double value);
+
+        void EndRow();
+
+        // Passes the buffered text to the sink
+        void Flush();
+
+    private:
+        void Separate();
+        void Append(std::string_view text);
+
+        char        _separator;
+        Sink        _sink;
+        size_t      _chunk_size;
+        std::string _chunk;
+        bool        _is_row_start = true;
+    };
+} // namespace utils
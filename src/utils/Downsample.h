@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace utils {
+    /**
+     * Largest-Triangle-Three-Buckets downsampling of a series ordered by x.
+     *
+     * Keeps the first and last points and, from each of the threshold - 2 buckets between
+     * them, the point forming the largest triangle with the point kept from the previous
+     * bucket and the average of the next bucket. Peaks and troughs survive, unlike with
+     * plain striding. Returns the indexes of the kept points in ascending order; all of them
+     * when the series is not longer than the threshold.
+     */
+    template <typename XOf, typename YOf>
+    std::vector<size_t> DownsampleLttb(size_t count, size_t threshold, XOf&& x_of, YOf&& y_of) {
+        std::vector<size_t> kept;
+        if (threshold >= count || threshold < 3) {
+            kept.resize(count);
+            std::iota(kept.begin(), kept.end(), size_t{0});
+            return kept;
+        }
+
+        kept.reserve(threshold);
+        kept.push_back(0);
+
+        // Buckets split the points between the first and the last one
+        const double bucket_size = static_cast<double>(count - 2) / (threshold - 2);
+        size_t       previous    = 0;
+
+        for (size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+            const auto begin = static_cast<size_t>(bucket * bucket_size) + 1;
+            const auto end   = static_cast<size_t>((bucket + 1) * bucket_size) + 1;
+
+            // Average of the next bucket, or the last point for the last bucket
+            const size_t next_begin = end;
+            const size_t next_end =
+                std::min(static_cast<size_t>((bucket + 2) * bucket_size) + 1, count - 1);
+            double average_x = 0.0;
+            double average_y = 0.0;
+            if (next_begin < next_end) {
+                for (size_t index = next_begin; index < next_end; ++index) {
+                    average_x += x_of(index);
+                    average_y += y_of(index);
+                }
+                average_x /= static_cast<double>(next_end - next_begin);
+                average_y /= static_cast<double>(next_end - next_begin);
+            } else {
+                average_x = x_of(count - 1);
+                average_y = y_of(count - 1);
+            }
+
+            const double previous_x = x_of(previous);
+            const double previous_y = y_of(previous);
+
+            size_t chosen   = begin;
+            double max_area = -1.0;
+            for (size_t index = begin; index < end; ++index) {
+                const double area = std::abs((previous_x - average_x) * (y_of(index) - previous_y) -
+                                             (previous_x - x_of(index)) * (average_y - previous_y));
+                if (area > max_area) {
+                    max_area = area;
+                    chosen   = index;
+                }
+            }
+
+            kept.push_back(chosen);
+            previous = chosen;
+        }
+
+        kept.push_back(count - 1);
+        return kept;
+    }
+} // namespace utils
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace utils {
+    /**
+     * Open-addressing hash map keyed by account login.
+     *
+     * Linear probing over a power-of-two table kept at most half full, with Fibonacci hashing
+     * of the login. Slots live in one contiguous vector, so probing stays within a cache line
+     * or two and there is no per-entry allocation.
+     */
+    template <typename Value>
+    class FlatLoginMap {
+    public:
+        explicit FlatLoginMap(size_t expected_size = 0) { Reserve(expected_size); }
+
+        void Reserve(size_t expected_size) {
+            size_t capacity = 16;
+            while (capacity < expected_size * 2) {
+                capacity <<= 1;
+            }
+            if (capacity > _slots.size()) {
+                Rehash(capacity);
+            }
+        }
+
+        // Pointer to the value of the login and whether it was inserted by this call
+        std::pair<Value*, bool> TryEmplace(int login) {
+            if ((_size + 1) * 2 > _slots.size()) {
+                Rehash(_slots.size() * 2);
+            }
+
+            Slot& slot = _slots[Probe(login)];
+            if (slot.is_occupied) {
+                return {&slot.value, false};
+            }
+
+            slot.is_occupied = true;
+            slot.login       = login;
+            slot.value       = Value{};
+            ++_size;
+
+            return {&slot.value, true};
+        }
+
+        Value* Find(int login) {
+            Slot& slot = _slots[Probe(login)];
+            return slot.is_occupied ? &slot.value : nullptr;
+        }
+
+        const Value* Find(int login) const {
+            const Slot& slot = _slots[Probe(login)];
+            return slot.is_occupied ? &slot.value : nullptr;
+        }
+
+        template <typename Visitor>
+        void ForEach(Visitor&& visitor) const {
+            for (const auto& slot : _slots) {
+                if (slot.is_occupied) {
+                    visitor(slot.login, slot.value);
+                }
+            }
+        }
+
+        template <typename Visitor>
+        void ForEach(Visitor&& visitor) {
+            for (auto& slot : _slots) {
+                if (slot.is_occupied) {
+                    visitor(slot.login, slot.value);
+                }
+            }
+        }
+
+        [[nodiscard]] size_t Size() const { return _size; }
+
+        void Clear() {
+            for (auto& slot : _slots) {
+                slot.is_occupied = false;
+            }
+            _size = 0;
+        }
+
+    private:
+        struct Slot {
+            int   login       = 0;
+            bool  is_occupied = false;
+            Value value{};
+        };
+
+        // Slot holding the login, or the empty slot where it would be inserted
+        [[nodiscard]] size_t Probe(int login) const {
+            const uint64_t hash  = static_cast<uint32_t>(login) * 0x9E3779B97F4A7C15ull;
+            size_t         index = static_cast<size_t>(hash >> _shift) & _mask;
+
+            while (_slots[index].is_occupied && _slots[index].login != login) {
+                index = (index + 1) & _mask;
+            }
+            return index;
+        }
+
+        void Rehash(size_t capacity) {
+            std::vector<Slot> slots(capacity);
+            slots.swap(_slots);
+
+            _mask  = capacity - 1;
+            _shift = 64;
+            for (size_t bits = capacity; bits > 1; bits >>= 1) {
+                --_shift;
+            }
+            _size = 0;
+
+            for (auto& slot : slots) {
+                if (slot.is_occupied) {
+                    *TryEmplace(slot.login).first = std::move(slot.value);
+                }
+            }
+        }
+
+        std::vector<Slot> _slots;
+        size_t            _size  = 0;
+        size_t            _mask  = 0;
+        unsigned          _shift = 64;
+    };
+} // namespace utils
@@ -0,0 +1,106 @@
+#include "GroupMask.h"
+
+namespace utils {
+    GroupMask::GroupMask(std::string_view mask) {
+        while (!mask.empty()) {
+            const size_t     comma   = mask.find(',');
+            std::string_view pattern = mask.substr(0, comma);
+            mask.remove_prefix(comma == std::string_view::npos ? mask.size() : comma + 1);
+
+            if (pattern.empty()) {
+                continue;
+            }
+            if (pattern.front() == '!') {
+                pattern.remove_prefix(1);
+                _excluded.push_back(Compile(pattern));
+            } else {
+                _included.push_back(Compile(pattern));
+            }
+        }
+    }
+
+    bool GroupMask::Matches(std::string_view group) const {
+        bool is_included = false;
+        for (const auto& pattern : _included) {
+            if (Matches(pattern, group)) {
+                is_included = true;
+                break;
+            }
+        }
+        if (!is_included) {
+            return false;
+        }
+
+        for (const auto& pattern : _excluded) {
+            if (Matches(pattern, group)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    GroupBitset GroupMask::Select(const std::vector<std::string>& groups) const {
+        GroupBitset selected(groups.size());
+        for (size_t id = 0; id < groups.size(); ++id) {
+            if (Matches(groups[id])) {
+                selected.Set(static_cast<uint32_t>(id));
+            }
+        }
+        return selected;
+    }
+
+    GroupMask::Pattern GroupMask::Compile(std::string_view pattern) {
+        Pattern compiled;
+        compiled.is_prefixed = pattern.empty() || pattern.front() != '*';
+        compiled.is_suffixed = pattern.empty() || pattern.back() != '*';
+
+        while (!pattern.empty()) {
+            const size_t star = pattern.find('*');
+            if (star != 0) {
+                compiled.parts.emplace_back(pattern.substr(0, star));
+            }
+            pattern.remove_prefix(star == std::string_view::npos ? pattern.size() : star + 1);
+        }
+        return compiled;
+    }
+
+    bool GroupMask::Matches(const Pattern& pattern, std::string_view group) {
+        const auto& parts = pattern.parts;
+        if (parts.empty()) {
+            // "*" matches everything, an empty pattern only the empty name
+            return !pattern.is_prefixed || group.empty();
+        }
+
+        size_t first = 0;
+        size_t last  = parts.size();
+
+        if (pattern.is_prefixed) {
+            if (!group.starts_with(parts.front())) {
+                return false;
+            }
+            group.remove_prefix(parts.front().size());
+            ++first;
+        }
+
+        if (pattern.is_suffixed && first < last) {
+            if (!group.ends_with(parts.back())) {
+                return false;
+            }
+            group.remove_suffix(parts.back().size());
+            --last;
+        } else if (pattern.is_suffixed) {
+            // A single literal part anchored at both ends must be the whole name
+            return group.empty();
+        }
+
+        // The leftmost occurrence of every middle part leaves the most room for the next one
+        for (size_t index = first; index < last; ++index) {
+            const size_t position = group.find(parts[index]);
+            if (position == std::string_view::npos) {
+                return false;
+            }
+            group.remove_prefix(position + parts[index].size());
+        }
+        return true;
+    }
+} // namespace utils
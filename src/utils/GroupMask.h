@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+    // Set of group IDs, the IDs being positions in an interned group list
+    class GroupBitset {
+    public:
+        explicit GroupBitset(size_t size = 0) : _words((size + 63) / 64, 0) {}
+
+        void Set(uint32_t id) { _words[id / 64] |= uint64_t{1} << (id % 64); }
+
+        [[nodiscard]] bool Test(uint32_t id) const {
+            return id / 64 < _words.size() && (_words[id / 64] >> (id % 64) & 1) != 0;
+        }
+
+    private:
+        std::vector<uint64_t> _words;
+    };
+
+    /**
+     * Group mask in the server syntax, compiled once and matched without allocating.
+     *
+     * A mask is a comma-separated list of patterns where '*' matches any run of characters,
+     * including none. Patterns starting with '!' exclude the groups they match: a group is
+     * selected when it matches at least one plain pattern and no excluded one, whatever the
+     * order of the patterns. Matching is case-sensitive, as group names are.
+     */
+    class GroupMask {
+    public:
+        explicit GroupMask(std::string_view mask);
+
+        [[nodiscard]] bool Matches(std::string_view group) const;
+
+        // IDs of the matching groups of the list
+        [[nodiscard]] GroupBitset Select(const std::vector<std::string>& groups) const;
+
+    private:
+        // Literal runs between the '*' of a pattern
+        struct Pattern {
+            std::vector<std::string> parts;
+            bool                     is_prefixed = false; // First part anchored at the start
+            bool                     is_suffixed = false; // Last part anchored at the end
+        };
+
+        static Pattern Compile(std::string_view pattern);
+
+        static bool Matches(const Pattern& pattern, std::string_view group);
+
+        std::vector<Pattern> _included;
+        std::vector<Pattern> _excluded;
+    };
+} // namespace utils
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace utils {
+    /**
+     * Mergeable histogram over fixed logarithmic buckets.
+     *
+     * Magnitudes are split into powers of two, each divided into sub_buckets equal parts, so a
+     * bucket is at most 1/sub_buckets of its value wide. Negative values use a mirrored set of
+     * buckets. Memory does not depend on the number of values, and histograms of separate
+     * chunks merge by adding their buckets, which gives the same result as one pass.
+     */
+    class LogHistogram {
+    public:
+        static constexpr int    sub_buckets  = 8;
+        static constexpr int    min_exponent = -10; // Magnitudes below 2^-10 share the first bucket
+        static constexpr int    max_exponent = 50;  // Magnitudes above 2^50 share the last one
+        static constexpr size_t bucket_count =
+            static_cast<size_t>(max_exponent - min_exponent) * sub_buckets;
+
+        void Add(double value) {
+            if (!std::isfinite(value)) {
+                return;
+            }
+
+            ++_count;
+            _min = std::min(_min, value);
+            _max = std::max(_max, value);
+
+            if (value > 0.0) {
+                const size_t bucket = Bucket(value);
+                ++_positive[bucket];
+                _positive_sums[bucket] += value;
+                _positive_sum += value;
+            } else if (value < 0.0) {
+                ++_negative[Bucket(-value)];
+            } else {
+                ++_zeros;
+            }
+        }
+
+        void Merge(const LogHistogram& other) {
+            for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                _positive[bucket] += other._positive[bucket];
+                _positive_sums[bucket] += other._positive_sums[bucket];
+                _negative[bucket] += other._negative[bucket];
+            }
+            _zeros += other._zeros;
+            _count += other._count;
+            _positive_sum += other._positive_sum;
+            _min = std::min(_min, other._min);
+            _max = std::max(_max, other._max);
+        }
+
+        [[nodiscard]] uint64_t Count() const { return _count; }
+
+        // Value below which the given share of the values lies, 0 when empty
+        [[nodiscard]] double Quantile(double share) const {
+            if (_count == 0) {
+                return 0.0;
+            }
+
+            const auto rank = static_cast<uint64_t>(
+                std::clamp(share, 0.0, 1.0) * static_cast<double>(_count - 1));
+
+            // Most negative values first, then zeros, then positive values in ascending order
+            uint64_t seen = 0;
+            for (size_t bucket = bucket_count; bucket-- > 0;) {
+                seen += _negative[bucket];
+                if (seen > rank) {
+                    return std::clamp(-Midpoint(bucket), _min, _max);
+                }
+            }
+            seen += _zeros;
+            if (seen > rank) {
+                return 0.0;
+            }
+            for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                seen += _positive[bucket];
+                if (seen > rank) {
+                    return std::clamp(Midpoint(bucket), _min, _max);
+                }
+            }
+            return _max;
+        }
+
+        // Part of the positive sum held by the largest positive values making up the given share
+        [[nodiscard]] double TopShare(double share) const {
+            uint64_t positive_count = 0;
+            for (const auto count : _positive) {
+                positive_count += count;
+            }
+            if (positive_count == 0 || _positive_sum <= 0.0) {
+                return 0.0;
+            }
+
+            double remaining = std::ceil(std::clamp(share, 0.0, 1.0) * positive_count);
+            double sum       = 0.0;
+            for (size_t bucket = bucket_count; bucket-- > 0 && remaining > 0.0;) {
+                const auto count = static_cast<double>(_positive[bucket]);
+                if (count == 0.0) {
+                    continue;
+                }
+
+                // Values of a partly taken bucket are counted at its average
+                const double taken = std::min(count, remaining);
+                sum += _positive_sums[bucket] * taken / count;
+                remaining -= taken;
+            }
+            return sum / _positive_sum;
+        }
+
+    private:
+        static size_t Bucket(double magnitude) {
+            int          exponent = 0;
+            const double mantissa = std::frexp(magnitude, &exponent); // [0.5, 1)
+            const int    octave   = exponent - 1;
+
+            if (octave < min_exponent) {
+                return 0;
+            }
+            if (octave >= max_exponent) {
+                return bucket_count - 1;
+            }
+
+            const auto sub = static_cast<size_t>((mantissa * 2.0 - 1.0) * sub_buckets);
+            return static_cast<size_t>(octave - min_exponent) * sub_buckets +
+                   std::min<size_t>(sub, sub_buckets - 1);
+        }
+
+        static double Midpoint(size_t bucket) {
+            const int    octave = static_cast<int>(bucket / sub_buckets) + min_exponent;
+            const double sub    = static_cast<double>(bucket % sub_buckets);
+            return std::ldexp(1.0 + (sub + 0.5) / sub_buckets, octave);
+        }
+
+        std::array<uint64_t, bucket_count> _positive{};
+        std::array<double, bucket_count>   _positive_sums{};
+        std::array<uint64_t, bucket_count> _negative{};
+        uint64_t                           _zeros        = 0;
+        uint64_t                           _count        = 0;
+        double                             _positive_sum = 0.0;
+        double                             _min          = std::numeric_limits<double>::max();
+        double                             _max          = std::numeric_limits<double>::lowest();
+    };
+} // namespace utils
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace utils {
+    // Order-preserving unsigned key of a signed login
+    inline uint64_t LoginSortKey(int login) {
+        return static_cast<uint32_t>(login) ^ 0x80000000u;
+    }
+
+    // Order-preserving unsigned key of a double: negatives are inverted, positives get the sign bit
+    inline uint64_t DoubleSortKey(double value) {
+        // -0.0 and 0.0 must tie
+        const uint64_t bits = std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value);
+        return bits & 0x8000000000000000ull ? ~bits : bits | 0x8000000000000000ull;
+    }
+
+    /**
+     * LSD radix sort of an index permutation by 64-bit unsigned keys, 8 bits per pass.
+     *
+     * Only the permutation moves, the records stay in place. Passes where every key has the
+     * same byte are skipped, so 32-bit keys cost four passes at most. The sort is stable.
+     *
+     * Every pass is split into chunks of the permutation: parallel_for(chunks, function) must
+     * call function(chunk) for each chunk and return once all of them finished. Histograms are
+     * kept per chunk and merged bucket by bucket, so the result does not depend on the split.
+     */
+    template <typename ParallelFor>
+    std::vector<uint32_t> RadixSortKeys(const std::vector<uint64_t>& keys,
+                                        size_t                       chunks,
+                                        ParallelFor&&                parallel_for) {
+        const size_t          count = keys.size();
+        std::vector<uint32_t> indices(count);
+        std::iota(indices.begin(), indices.end(), 0u);
+
+        if (count < 2) {
+            return indices;
+        }
+
+        chunks = std::clamp<size_t>(chunks, 1, count);
+
+        std::vector<uint32_t>                buffer(count);
+        std::vector<std::array<size_t, 256>> histograms(chunks);
+
+        const auto slice_begin = [&](size_t chunk) { return count * chunk / chunks; };
+
+        for (unsigned shift = 0; shift < 64; shift += 8) {
+            parallel_for(chunks, [&](size_t chunk) {
+                auto& histogram = histograms[chunk];
+                histogram.fill(0);
+                for (size_t i = slice_begin(chunk); i < slice_begin(chunk + 1); ++i) {
+                    ++histogram[keys[indices[i]] >> shift & 0xFF];
+                }
+            });
+
+            const size_t first_bucket = keys[indices.front()] >> shift & 0xFF;
+            size_t       first_size   = 0;
+            for (const auto& histogram : histograms) {
+                first_size += histogram[first_bucket];
+            }
+            if (first_size == count) {
+                continue;
+            }
+
+            // Bucket-major offsets keep equal bytes in chunk order
+            size_t offset = 0;
+            for (size_t bucket = 0; bucket < 256; ++bucket) {
+                for (auto& histogram : histograms) {
+                    const size_t size = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += size;
+                }
+            }
+
+            parallel_for(chunks, [&](size_t chunk) {
+                auto& histogram = histograms[chunk];
+                for (size_t i = slice_begin(chunk); i < slice_begin(chunk + 1); ++i) {
+                    const uint32_t index                             = indices[i];
+                    buffer[histogram[keys[index] >> shift & 0xFF]++] = index;
+                }
+            });
+            indices.swap(buffer);
+        }
+
+        return indices;
+    }
+
+    // Single-threaded sort of the permutation by key_of(index)
+    template <typename KeyFunction>
+    std::vector<uint32_t> RadixSortIndices(size_t count, KeyFunction&& key_of) {
+        std::vector<uint64_t> keys(count);
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = key_of(i);
+        }
+
+        return RadixSortKeys(keys, 1, [](size_t chunks, auto&& function) {
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                function(chunk);
+            }
+        });
+    }
+} // namespace utils
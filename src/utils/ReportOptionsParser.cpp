@@ -0,0 +1,473 @@
+#include "ReportOptionsParser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <string_view>
+#include <utility>
+
+#include "utils/Utils.h"
+
+namespace utils {
+    namespace {
+        constexpr time_t day_seconds          = 86400;
+        constexpr long   default_span_days    = 366;
+        constexpr long   default_history_days = 3660;
+        constexpr size_t default_max_rows     = 1000000;
+        constexpr size_t max_batch_size       = 64;
+        constexpr size_t min_history_points   = 3;
+        constexpr size_t max_history_points   = 10000;
+
+        // Batch entry fields left out take the values of the request
+        constexpr time_t unset_time = -1;
+
+        using Value = rapidjson::Value;
+
+        std::string_view View(const Value& value) {
+            return {value.GetString(), value.GetStringLength()};
+        }
+
+        // Stores a string field limited to the given values
+        template <size_t Count>
+        bool ParseChoice(const Value&                                      value,
+                         const std::array<std::string_view, Count>&        choices,
+                         size_t*                                           choice) {
+            if (!value.IsString()) {
+                return false;
+            }
+
+            const auto it = std::find(choices.begin(), choices.end(), View(value));
+            *choice       = static_cast<size_t>(it - choices.begin());
+            return it != choices.end();
+        }
+
+        bool ParseCurrency(const Value& value, ReportOptions& options) {
+            if (!value.IsString() || value.GetStringLength() != 3) {
+                return false;
+            }
+
+            const std::string_view currency = View(value);
+            if (!std::all_of(currency.begin(), currency.end(), [](char c) {
+                    return c >= 'A' && c <= 'Z';
+                })) {
+                return false;
+            }
+
+            options.currency.assign(currency);
+            return true;
+        }
+
+        bool ParseBatch(const Value& value, ReportOptions& options) {
+            if (!value.IsArray() || value.Empty() || value.Size() > max_batch_size) {
+                return false;
+            }
+
+            options.batch.clear();
+            for (const auto& entry : value.GetArray()) {
+                if (!entry.IsObject()) {
+                    return false;
+                }
+
+                ReportRange range{{}, unset_time, unset_time};
+                for (const auto& member : entry.GetObject()) {
+                    const std::string_view name = View(member.name);
+                    if (name == "group") {
+                        if (!member.value.IsString()) {
+                            return false;
+                        }
+                        range.group_mask.assign(View(member.value));
+                    } else if (name == "from" || name == "to") {
+                        if (!member.value.IsInt64() || member.value.GetInt64() < 0) {
+                            return false;
+                        }
+                        (name == "from" ? range.from : range.to) = member.value.GetInt64();
+                    }
+                }
+                options.batch.push_back(std::move(range));
+            }
+            return true;
+        }
+
+        // Parses one member into the options, false when its type or value is invalid
+        using FieldParser = bool (*)(const Value& value, ReportOptions& options);
+
+        struct Field {
+            std::string_view name;
+            FieldParser      parse;
+        };
+
+        // Sorted by name for the lookup of each request member
+        constexpr std::array<Field, 31> fields = {{
+            {"accept_encoding",
+             [](const Value& value, ReportOptions& options) {
+                 options.rows_codec = SelectCompressionCodec(value);
+                 return value.IsArray();
+             }},
+            {"async",
+             [](const Value& value, ReportOptions& options) {
+                 options.is_async = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"batch", ParseBatch},
+            {"bounded_memory",
+             [](const Value& value, ReportOptions& options) {
+                 options.bounded_memory = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"cancel_job",
+             [](const Value& value, ReportOptions& options) {
+                 options.cancel_job = value.IsUint64() ? value.GetUint64() : 0;
+                 return value.IsUint64();
+             }},
+            {"compact",
+             [](const Value& value, ReportOptions& options) {
+                 options.compact_rows = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"currency", ParseCurrency},
+            {"exposure",
+             [](const Value& value, ReportOptions& options) {
+                 options.exposure = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"format",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 3> formats = {"table", "csv", "tsv"};
+                 size_t                                    format  = 0;
+                 if (!ParseChoice(value, formats, &format)) {
+                     return false;
+                 }
+                 options.export_format = format == 1   ? ExportFormat::Csv
+                                         : format == 2 ? ExportFormat::Tsv
+                                                       : ExportFormat::None;
+                 return true;
+             }},
+            {"from",
+             [](const Value& value, ReportOptions& options) {
+                 options.from = value.IsInt64() ? value.GetInt64() : 0;
+                 return value.IsInt64() && options.from >= 0;
+             }},
+            {"group",
+             [](const Value& value, ReportOptions& options) {
+                 if (!value.IsString()) {
+                     return false;
+                 }
+                 options.group_mask.assign(value.GetString(), value.GetStringLength());
+                 return true;
+             }},
+            {"intraday",
+             [](const Value& value, ReportOptions& options) {
+                 options.intraday = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"limit",
+             [](const Value& value, ReportOptions& options) {
+                 options.row_limit = value.IsUint64() ? value.GetUint64() : 0;
+                 return value.IsUint64();
+             }},
+            {"login",
+             [](const Value& value, ReportOptions& options) {
+                 options.login = value.IsInt() ? value.GetInt() : 0;
+                 return value.IsInt() && options.login > 0;
+             }},
+            {"manager_id",
+             [](const Value& value, ReportOptions& options) {
+                 options.manager_id = value.IsInt() ? value.GetInt() : -1;
+                 return value.IsInt();
+             }},
+            {"metrics",
+             [](const Value& value, ReportOptions& options) {
+                 options.metrics = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"mode",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 3> modes = {"table", "delta", "history"};
+                 size_t                                    mode  = 0;
+                 if (!ParseChoice(value, modes, &mode)) {
+                     return false;
+                 }
+                 options.mode = mode == 1   ? ReportMode::Delta
+                                : mode == 2 ? ReportMode::History
+                                            : ReportMode::Table;
+                 return true;
+             }},
+            {"offset",
+             [](const Value& value, ReportOptions& options) {
+                 options.row_offset = value.IsUint64() ? value.GetUint64() : 0;
+                 return value.IsUint64();
+             }},
+            {"order",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 4> orders = {"DESC", "desc", "ASC", "asc"};
+                 size_t                                    order  = 0;
+                 if (!ParseChoice(value, orders, &order)) {
+                     return false;
+                 }
+                 options.order_descending = order < 2;
+                 return true;
+             }},
+            {"order_by",
+             [](const Value& value, ReportOptions& options) {
+                 if (!value.IsString()) {
+                     return false;
+                 }
+                 options.order_by.assign(value.GetString(), value.GetStringLength());
+                 return true;
+             }},
+            {"points",
+             [](const Value& value, ReportOptions& options) {
+                 options.history_points = value.IsUint64() ? value.GetUint64() : 0;
+                 return options.history_points >= min_history_points &&
+                        options.history_points <= max_history_points;
+             }},
+            {"push",
+             [](const Value& value, ReportOptions& options) {
+                 options.is_push = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"rate_policy",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 3> policies = {
+                     "mark", "skip", "last_known"};
+                 size_t policy = 0;
+                 if (!ParseChoice(value, policies, &policy)) {
+                     return false;
+                 }
+                 options.rate_policy.assign(policies[policy]);
+                 return true;
+             }},
+            {"rates",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 2> sources = {"spot", "historical"};
+                 size_t                                    source  = 0;
+                 if (!ParseChoice(value, sources, &source)) {
+                     return false;
+                 }
+                 options.historical_rates = source == 1;
+                 return true;
+             }},
+            {"refresh",
+             [](const Value& value, ReportOptions& options) {
+                 options.is_refresh    = value.IsUint64();
+                 options.refresh_since = value.IsUint64() ? value.GetUint64() : 0;
+                 return value.IsUint64();
+             }},
+            {"rollup",
+             [](const Value& value, ReportOptions& options) {
+                 options.rollup = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"snapshot",
+             [](const Value& value, ReportOptions& options) {
+                 constexpr std::array<std::string_view, 3> snapshots = {"all", "latest", "first"};
+                 size_t                                    snapshot  = 0;
+                 if (!ParseChoice(value, snapshots, &snapshot)) {
+                     return false;
+                 }
+                 options.snapshot = snapshot == 1   ? SnapshotMode::Latest
+                                    : snapshot == 2 ? SnapshotMode::First
+                                                    : SnapshotMode::All;
+                 return true;
+             }},
+            {"statistics",
+             [](const Value& value, ReportOptions& options) {
+                 options.statistics = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+            {"threads",
+             [](const Value& value, ReportOptions& options) {
+                 options.threads = value.IsUint() ? value.GetUint() : 0;
+                 return value.IsUint();
+             }},
+            {"to",
+             [](const Value& value, ReportOptions& options) {
+                 options.to = value.IsInt64() ? value.GetInt64() : 0;
+                 return value.IsInt64() && options.to >= 0;
+             }},
+            {"verify",
+             [](const Value& value, ReportOptions& options) {
+                 options.verify = value.IsBool() && value.GetBool();
+                 return value.IsBool();
+             }},
+        }};
+
+        static_assert(std::ranges::is_sorted(fields, {}, &Field::name),
+                      "request fields must stay sorted");
+
+        size_t ReadLimit(const char* name, size_t fallback) {
+            const char* env = std::getenv(name);
+            if (!env) {
+                return fallback;
+            }
+
+            const unsigned long long value = std::strtoull(env, nullptr, 10);
+            return value > 0 ? static_cast<size_t>(value) : fallback;
+        }
+    } // namespace
+
+    const RequestLimits& GetRequestLimits() {
+        static const RequestLimits limits = {
+            static_cast<time_t>(ReadLimit("DAILY_EQUITY_MAX_SPAN_DAYS", default_span_days)) *
+                day_seconds,
+            static_cast<time_t>(ReadLimit("DAILY_EQUITY_MAX_HISTORY_DAYS", default_history_days)) *
+                day_seconds,
+            ReadLimit("DAILY_EQUITY_MAX_ROWS", default_max_rows),
+            ReadLimit("DAILY_EQUITY_ALLOW_VERIFY", 0) != 0,
+        };
+        return limits;
+    }
+
+    bool ParseReportOptions(const rapidjson::Value& request,
+                            ReportOptions*          options,
+                            std::string*            error) {
+        *options = ReportOptions{};
+
+        if (!request.IsObject()) {
+            *error = "The request must be an object";
+            return false;
+        }
+
+        bool has_from = false;
+        bool has_to   = false;
+
+        for (const auto& member : request.GetObject()) {
+            const std::string_view name = View(member.name);
+
+            const auto field = std::ranges::lower_bound(fields, name, {}, &Field::name);
+            if (field == fields.end() || field->name != name) {
+                continue;
+            }
+
+            if (!field->parse(member.value, *options)) {
+                *error = "Invalid value of \"" + std::string(name) + "\"";
+                return false;
+            }
+
+            has_from = has_from || name == "from";
+            has_to   = has_to || name == "to";
+        }
+
+        if (!has_to) {
+            options->to            = std::time(nullptr);
+            options->is_open_ended = true;
+        }
+        if (!has_from) {
+            // A delta compares two days, so its base defaults to the day before "to"
+            options->from = options->mode == ReportMode::Delta
+                                ? std::max<time_t>(DayStart(options->to) - day_seconds, 0)
+                                : DayStart(options->to);
+        }
+
+        const RequestLimits& limits = GetRequestLimits();
+
+        if (options->from > options->to) {
+            *error = "\"from\" must not be later than \"to\"";
+            return false;
+        }
+
+        // A single login stays small over long ranges, so its history has its own limit
+        const time_t max_span =
+            options->mode == ReportMode::History ? limits.max_history_span : limits.max_span;
+        if (options->to - options->from >= max_span) {
+            *error = "The range must be shorter than " + std::to_string(max_span / day_seconds) +
+                     " days";
+            return false;
+        }
+
+        // A verified report is built twice, so only operators may turn it on
+        if (options->verify && !limits.allow_verify) {
+            *error = "\"verify\" is disabled on this server";
+            return false;
+        }
+
+        for (size_t index = 0; index < options->batch.size(); ++index) {
+            ReportRange& range = options->batch[index];
+            if (range.group_mask.empty()) {
+                range.group_mask = options->group_mask;
+            }
+            if (range.to == unset_time) {
+                range.to = options->to;
+            }
+            if (range.from == unset_time) {
+                range.from = has_from ? options->from : DayStart(range.to);
+            }
+
+            if (range.from > range.to || range.to - range.from >= limits.max_span) {
+                *error = "Invalid range of \"batch\" entry " + std::to_string(index);
+                return false;
+            }
+        }
+
+        if (!options->batch.empty() &&
+            (options->mode != ReportMode::Table || options->export_format != ExportFormat::None ||
+             options->bounded_memory || options->is_refresh)) {
+            *error = "\"batch\" only supports table reports";
+            return false;
+        }
+
+        if (options->exposure &&
+            (options->mode != ReportMode::Table || options->export_format != ExportFormat::None ||
+             options->bounded_memory || options->is_refresh || !options->batch.empty())) {
+            *error = "\"exposure\" only supports single table reports";
+            return false;
+        }
+
+        // Open trades are current positions, they do not describe a range that ended before today
+        if (options->exposure && options->to < DayStart(std::time(nullptr))) {
+            *error = "\"exposure\" needs a range that includes the current day";
+            return false;
+        }
+
+        if (options->statistics &&
+            (options->mode != ReportMode::Table || options->export_format != ExportFormat::None ||
+             options->is_refresh || !options->batch.empty())) {
+            *error = "\"statistics\" only supports single table reports";
+            return false;
+        }
+
+        if (options->rollup &&
+            (options->mode != ReportMode::Table || options->export_format != ExportFormat::None ||
+             options->bounded_memory || options->is_refresh || !options->batch.empty() ||
+             options->exposure || options->statistics || options->snapshot != SnapshotMode::All)) {
+            *error = "\"rollup\" only supports single table reports with all snapshots";
+            return false;
+        }
+
+        if (options->mode == ReportMode::Delta) {
+            if (DayStart(options->from) == DayStart(options->to)) {
+                *error = "\"delta\" mode needs \"from\" and \"to\" on different days";
+                return false;
+            }
+            if (options->export_format != ExportFormat::None || options->is_refresh ||
+                options->bounded_memory) {
+                *error = "\"delta\" mode does not support \"format\", \"refresh\" or "
+                         "\"bounded_memory\"";
+                return false;
+            }
+        }
+
+        if (options->mode == ReportMode::History) {
+            if (options->login == 0) {
+                *error = "\"history\" mode requires \"login\"";
+                return false;
+            }
+            if (options->export_format != ExportFormat::None || options->is_refresh) {
+                *error = "\"history\" mode does not support \"format\" or \"refresh\"";
+                return false;
+            }
+        }
+
+        // Refresh replies are diffs of the plain equity table rows
+        if (options->is_refresh && (options->export_format != ExportFormat::None ||
+                                    options->bounded_memory || options->compact_rows)) {
+            *error = "\"refresh\" does not support \"format\", \"bounded_memory\" or \"compact\"";
+            return false;
+        }
+
+        options->row_limit = options->row_limit > 0 ? std::min(options->row_limit, limits.max_rows)
+                                                    : limits.max_rows;
+
+        return true;
+    }
+} // namespace utils
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+
+#include <rapidjson/document.h>
+
+#include "structures/ReportOptions.h"
+
+namespace utils {
+    // Server-side bounds of a request, read once from the environment
+    struct RequestLimits {
+        time_t max_span;         // DAILY_EQUITY_MAX_SPAN_DAYS, 366 days by default
+        time_t max_history_span; // DAILY_EQUITY_MAX_HISTORY_DAYS, 3660 days by default
+        size_t max_rows;         // DAILY_EQUITY_MAX_ROWS, 1000000 by default
+        bool   allow_verify;     // DAILY_EQUITY_ALLOW_VERIFY=1, off by default
+    };
+
+    const RequestLimits& GetRequestLimits();
+
+    /**
+     * Parses the request in one pass over its members into options with defaults.
+     *
+     * Known fields with a wrong type or value and ranges beyond the limits fail the request
+     * with a message for the user; unknown fields are ignored. A missing "to" is the current
+     * time and a missing "from" the start of that day, or of the day before in delta mode.
+     */
+    bool ParseReportOptions(const rapidjson::Value& request,
+                            ReportOptions*          options,
+                            std::string*            error);
+} // namespace utils
@@ -0,0 +1,99 @@
+#include "RowSpill.h"
+
+#include <iostream>
+
+#include <rapidjson/filereadstream.h>
+#include <rapidjson/reader.h>
+
+#include "utils/Utils.h"
+
+namespace utils {
+    RowSpill::RowSpill() : _file(std::tmpfile(), &std::fclose) {
+        if (!_file) {
+            std::cerr << "[DailyEquityReportInterface]: cannot create a row spill file"
+                      << std::endl;
+            return;
+        }
+
+        _stream =
+            std::make_unique<rapidjson::FileWriteStream>(_file.get(), _buffer, sizeof(_buffer));
+        _writer = std::make_unique<FileWriter>(*_stream);
+        _writer->StartArray();
+    }
+
+    bool RowSpill::Append(const ast::JSONArray& row) {
+        if (!_writer || _is_written || _is_failed) {
+            return false;
+        }
+
+        ++_rows;
+        if (!ast::accept(row, *_writer)) {
+            std::cerr << "[DailyEquityReportInterface]: row " << _rows
+                      << " cannot be written to the row spill file" << std::endl;
+            _is_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool RowSpill::Finish() {
+        if (!_writer || _is_failed) {
+            return false;
+        }
+
+        if (!_is_written) {
+            _writer->EndArray(static_cast<rapidjson::SizeType>(_rows));
+            _stream->Flush();
+            _is_written = true;
+        }
+
+        if (std::ferror(_file.get())) {
+            std::cerr << "[DailyEquityReportInterface]: row spill file write failed" << std::endl;
+            return false;
+        }
+
+        std::rewind(_file.get());
+        return true;
+    }
+
+    bool RowSpill::ReadRows(rapidjson::Value& rows, rapidjson::Document::AllocatorType& allocator) {
+        if (!Finish()) {
+            return false;
+        }
+
+        rapidjson::FileReadStream stream(_file.get(), _buffer, sizeof(_buffer));
+        rapidjson::Reader         reader;
+        bool                      is_parsed = false;
+
+        // The document shares the response allocator, so its tree is moved out without copying
+        rapidjson::Document document(&allocator);
+        auto generator = [&](rapidjson::Document& handler) {
+            StaticStringFilter<rapidjson::Document> filter(handler);
+            is_parsed = !reader.Parse(stream, filter).IsError();
+            return is_parsed;
+        };
+        document.Populate(generator);
+
+        if (!is_parsed || !document.IsArray()) {
+            std::cerr << "[DailyEquityReportInterface]: row spill file is malformed" << std::endl;
+            return false;
+        }
+
+        rows.Swap(document);
+        return true;
+    }
+
+    bool RowSpill::ReadText(std::string* text) {
+        if (!Finish()) {
+            return false;
+        }
+
+        text->clear();
+        size_t size = 0;
+        while ((size = std::fread(_buffer, 1, sizeof(_buffer), _file.get())) > 0) {
+            text->append(_buffer, size);
+        }
+
+        return !std::ferror(_file.get());
+    }
+} // namespace utils
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/writer.h>
+
+#include "ast/Ast.hpp"
+
+namespace utils {
+    /**
+     * Table rows written as one JSON array to an anonymous temporary file.
+     *
+     * Rows are serialized as they are formatted, so only the write buffer stays in memory
+     * until the array is read back into the response. The file is removed when closed.
+     */
+    class RowSpill {
+    public:
+        RowSpill();
+
+        RowSpill(const RowSpill&)            = delete;
+        RowSpill& operator=(const RowSpill&) = delete;
+
+        // False when the temporary file could not be created
+        [[nodiscard]] bool IsOpen() const { return _file != nullptr; }
+
+        // False once a row could not be written, e.g. a NaN or infinite value; later rows and
+        // reads fail too, as the array in the file is cut at that row
+        bool Append(const ast::JSONArray& row);
+
+        [[nodiscard]] size_t Size() const { return _rows; }
+
+        // Parses the array into the allocator, sharing literals the report emits
+        bool ReadRows(rapidjson::Value& rows, rapidjson::Document::AllocatorType& allocator);
+
+        // Text of the array, for compressed rows
+        bool ReadText(std::string* text);
+
+    private:
+        bool Finish();
+
+        using FileWriter = rapidjson::Writer<rapidjson::FileWriteStream>;
+
+        std::unique_ptr<FILE, int (*)(FILE*)>      _file;
+        char                                       _buffer[64 * 1024];
+        std::unique_ptr<rapidjson::FileWriteStream> _stream;
+        std::unique_ptr<FileWriter>                _writer;
+        size_t                                     _rows       = 0;
+        bool                                       _is_written = false;
+        bool                                       _is_failed  = false;
+    };
+} // namespace utils
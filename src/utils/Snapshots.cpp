@@ -0,0 +1,38 @@
+#include "Snapshots.h"
+
+#include "utils/FlatLoginMap.h"
+
+namespace utils {
+    void SelectSnapshots(std::vector<EquityRecord>& records, const SnapshotMode& mode) {
+        if (mode == SnapshotMode::All) {
+            return;
+        }
+
+        // Login -> position of its kept record in the compacted prefix
+        FlatLoginMap<size_t> positions(records.size());
+        size_t               kept = 0;
+
+        for (size_t index = 0; index < records.size(); ++index) {
+            auto [position, is_inserted] = positions.TryEmplace(records[index].login);
+
+            if (is_inserted) {
+                *position = kept;
+                if (index != kept) {
+                    records[kept] = std::move(records[index]);
+                }
+                ++kept;
+                continue;
+            }
+
+            EquityRecord& current     = records[*position];
+            const bool    is_replaced = mode == SnapshotMode::Latest
+                                            ? records[index].create_time > current.create_time
+                                            : records[index].create_time < current.create_time;
+            if (is_replaced) {
+                current = std::move(records[index]);
+            }
+        }
+
+        records.resize(kept);
+    }
+} // namespace utils
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+#include "Structures.h"
+#include "structures/ReportOptions.h"
+
+namespace utils {
+    // Keeps one record per login according to the mode, preserving first-appearance order
+    void SelectSnapshots(std::vector<EquityRecord>& records, const SnapshotMode& mode);
+} // namespace utils
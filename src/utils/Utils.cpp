@@ -1,15 +1,72 @@
 #include "Utils.h"
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+
 namespace utils {
+    namespace {
+        // Sorted literals of the report UI and the equity table
+        constexpr std::array<std::string_view, 104> static_strings = {
+        "#text", "AMOUNT", "ASC", "BALANCE", "BUY_LOTS", "Button", "COMMISSION", "CREATE_TIME",
+        "CREDIT", "CURRENCY", "Caches", "Column", "DESC", "Daily Equity Delta Report",
+        "Daily Equity Report", "Daily Equity Report Metrics", "Daily Equity Rollup",
+        "DailyEquityDeltaTable", "DailyEquityReportTable", "DailyEquityRollupTable", "EQUITY",
+        "EXPOSURE", "FLOATING_PL", "GROUP", "LOGIN", "Latency (ms)", "MARGIN", "MARGIN_FREE",
+        "MARGIN_LEVEL (%)", "PREV_BALANCE", "RECORDS", "Requests", "SELL_LOTS", "STATUS", "SWAP",
+        "Sizes", "Space", "TOTAL", "TRADES", "TRADES_PROFIT", "Table", "USD", "autoSave", "balance",
+        "buy_lots", "children", "closed", "columns", "commission", "compact", "constants",
+        "create_time", "credit", "currency", "data", "date-time", "dictionaries", "encoding",
+        "equity", "export", "exposure", "filter", "floating_pl", "group", "h1", "h2", "h3", "idCol",
+        "login", "margin", "margin_free", "margin_level", "metrics", "name", "new", "options",
+        "order", "orderBy", "p", "prevbalance", "profit", "props", "records", "rows", "rowsBlob",
+        "rowsCodec", "search", "select", "sell_lots", "showBookmarksBtn", "showExportBtn",
+        "showRefreshBtn", "showTotal", "sort", "status", "storage", "structure", "text",
+        "totalData", "totalDataTitle", "trades", "trades_profit", "type", "value"};
+
+        static_assert(std::ranges::is_sorted(static_strings), "static_strings must stay sorted");
+
+        template <typename Generator>
+        Value Populate(Generator& generator, rapidjson::Document::AllocatorType& allocator) {
+            // The document shares the response allocator, so its tree is moved out without copying
+            Document document(&allocator);
+            auto     filtered = [&](Document& handler) {
+                StaticStringFilter<Document> filter(handler);
+                return generator(filter);
+            };
+            document.Populate(filtered);
+
+            Value value;
+            value.Swap(document);
+            return value;
+        }
+    } // namespace
+
+    const char* FindStaticString(const char* str, rapidjson::SizeType length) {
+        const std::string_view value(str, length);
+        const auto it = std::lower_bound(static_strings.begin(), static_strings.end(), value);
+        return it != static_strings.end() && *it == value ? it->data() : nullptr;
+    }
+
+    rapidjson::Value ToJson(const ast::Node& node, rapidjson::Document::AllocatorType& allocator) {
+        auto generator = [&](auto& handler) { return ast::accept(node, handler); };
+        return Populate(generator, allocator);
+    }
+
     void CreateUI(const ast::Node&                    node,
                   rapidjson::Value&                   response,
                   rapidjson::Document::AllocatorType& allocator) {
-        // Content
-        Value node_object(kObjectType);
-        to_json(node, node_object, allocator);
+        Value node_object = ToJson(node, allocator);
+
+        CreateUI(node_object, response, allocator);
+    }
 
+    void CreateUI(rapidjson::Value&                   content,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator) {
+        // Content
         Value content_array(kArrayType);
-        content_array.PushBack(node_object, allocator);
+        content_array.PushBack(content, allocator);
 
         // Header
         Value header_array(kArrayType);
@@ -94,15 +151,49 @@ namespace utils {
         response.AddMember("ui", ui_object, allocator);
     }
 
+    rapidjson::Value CreateTableNode(const TableBuilder&                 table_builder,
+                                     rapidjson::Document::AllocatorType& allocator) {
+        auto  generator = [&](auto& handler) { return table_builder.Accept(handler); };
+        Value props     = Populate(generator, allocator);
+
+        Value table_object(kObjectType);
+        table_object.AddMember("type", "Table", allocator);
+        table_object.AddMember("props", props, allocator);
+
+        return table_object;
+    }
+
+    void AppendChild(rapidjson::Value&                   node,
+                     rapidjson::Value&                   child,
+                     rapidjson::Document::AllocatorType& allocator) {
+        if (!node.HasMember("children")) {
+            node.AddMember("children", Value(kArrayType), allocator);
+        }
+
+        node["children"].PushBack(child, allocator);
+    }
+
     std::string FormatTimestampToString(const time_t& timestamp, const std::string& format) {
         std::tm tm{};
         localtime_r(&timestamp, &tm);
 
+        // strftime into a stack buffer avoids constructing a stream per row
+        char         buffer[64];
+        const size_t size = std::strftime(buffer, sizeof(buffer), format.c_str(), &tm);
+        if (size > 0 || format.empty()) {
+            return {buffer, size};
+        }
+
         std::ostringstream oss;
         oss << std::put_time(&tm, format.c_str());
         return oss.str();
     }
 
+    time_t DayStart(const time_t& timestamp) {
+        constexpr time_t day = 86400;
+        return timestamp - ((timestamp % day) + day) % day;
+    }
+
     double TruncateDouble(const double& value, const int& digits) {
         const double factor = std::pow(10.0, digits);
         return std::trunc(value * factor) / factor;
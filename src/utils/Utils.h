@@ -9,16 +9,82 @@
 
 #include "Structures.h"
 #include "ast/Ast.hpp"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
 #include "structures/PluginStructures.h"
 #include <rapidjson/document.h>
 
 namespace utils {
+    // Static copy of a literal the report emits (keys, node types, column keys), or nullptr
+    const char* FindStaticString(const char* str, rapidjson::SizeType length);
+
+    /**
+     * SAX filter that passes known literals by reference, so a DOM built through it
+     * does not copy them into the response allocator.
+     */
+    template <typename Handler>
+    class StaticStringFilter {
+    public:
+        explicit StaticStringFilter(Handler& handler) : _handler(handler) {}
+
+        bool Null() { return _handler.Null(); }
+        bool Bool(bool b) { return _handler.Bool(b); }
+        bool Int(int i) { return _handler.Int(i); }
+        bool Uint(unsigned u) { return _handler.Uint(u); }
+        bool Int64(int64_t i) { return _handler.Int64(i); }
+        bool Uint64(uint64_t u) { return _handler.Uint64(u); }
+        bool Double(double d) { return _handler.Double(d); }
+        bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) {
+            return _handler.RawNumber(str, length, copy);
+        }
+        bool StartObject() { return _handler.StartObject(); }
+        bool EndObject(rapidjson::SizeType members) { return _handler.EndObject(members); }
+        bool StartArray() { return _handler.StartArray(); }
+        bool EndArray(rapidjson::SizeType elements) { return _handler.EndArray(elements); }
+
+        bool String(const char* str, rapidjson::SizeType length, bool copy) {
+            if (const char* static_str = copy ? FindStaticString(str, length) : nullptr) {
+                return _handler.String(static_str, length, false);
+            }
+            return _handler.String(str, length, copy);
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+            if (const char* static_str = copy ? FindStaticString(str, length) : nullptr) {
+                return _handler.Key(static_str, length, false);
+            }
+            return _handler.Key(str, length, copy);
+        }
+
+    private:
+        Handler& _handler;
+    };
+
+    // Serializes a node into the response allocator, sharing literals instead of copying them
+    rapidjson::Value ToJson(const ast::Node& node, rapidjson::Document::AllocatorType& allocator);
+
     void CreateUI(const ast::Node&                    node,
                   rapidjson::Value&                   response,
                   rapidjson::Document::AllocatorType& allocator);
 
+    // Same as above for content that is already built in the response allocator, moved in
+    void CreateUI(rapidjson::Value&                   content,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator);
+
+    // Table node whose props are emitted by the builder straight into the response allocator
+    rapidjson::Value CreateTableNode(const TableBuilder&                 table_builder,
+                                     rapidjson::Document::AllocatorType& allocator);
+
+    // Appends a child to the "children" array of a serialized node
+    void AppendChild(rapidjson::Value&                   node,
+                     rapidjson::Value&                   child,
+                     rapidjson::Document::AllocatorType& allocator);
+
     std::string FormatTimestampToString(const time_t&      timestamp,
                                         const std::string& format = "%Y.%m.%d %H:%M:%S");
 
     double TruncateDouble(const double& value, const int& digits);
+
+    // Start of the UTC day containing the timestamp
+    time_t DayStart(const time_t& timestamp);
 } // namespace utils
\ No newline at end of file
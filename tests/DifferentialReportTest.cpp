@@ -0,0 +1,807 @@
+// Builds reports over random books through every table path, the rollup and the delta, and
+// compares the rows and totals with a reference computed here from the records alone.
+// Usage: DifferentialReportTest [runs]
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FakeServer.h"
+#include "PluginInterface.h"
+
+namespace {
+    constexpr time_t book_start  = 1699920000; // 2023.11.14 00:00 UTC
+    constexpr size_t book_days   = 6;
+    constexpr time_t day_seconds = 86400;
+
+    // Money columns in table order, each with its value in a record
+    constexpr std::array<const char*, 10> money_columns = {"balance",
+                                                           "prevbalance",
+                                                           "floating_pl",
+                                                           "credit",
+                                                           "equity",
+                                                           "profit",
+                                                           "storage",
+                                                           "commission",
+                                                           "margin",
+                                                           "margin_free"};
+
+    double MoneyValue(const EquityRecord& record, size_t column) {
+        switch (column) {
+            case 0:
+                return record.balance;
+            case 1:
+                return record.prevbalance;
+            case 2:
+                return record.equity - record.balance;
+            case 3:
+                return record.credit;
+            case 4:
+                return record.equity;
+            case 5:
+                return record.profit;
+            case 6:
+                return record.storage;
+            case 7:
+                return record.commission;
+            case 8:
+                return record.margin;
+            default:
+                return record.margin_free;
+        }
+    }
+
+    double Truncate(double value) {
+        return std::trunc(value * 100.0) / 100.0;
+    }
+
+    std::string FormatTime(time_t time) {
+        char    buffer[32];
+        std::tm parts{};
+        gmtime_r(&time, &parts);
+        std::strftime(buffer, sizeof(buffer), "%Y.%m.%d %H:%M:%S", &parts);
+        return buffer;
+    }
+
+    // One table row by column key, numbers and strings apart
+    struct Row {
+        std::map<std::string, double>      numbers;
+        std::map<std::string, std::string> strings;
+
+        // Login and time, the login alone for a delta, or group and currency for the group
+        // totals of a rollup
+        [[nodiscard]] std::string Key() const {
+            if (!numbers.contains("login")) {
+                return strings.at("group") + " " + strings.at("currency");
+            }
+            const std::string login = std::to_string(static_cast<long>(numbers.at("login")));
+            if (!strings.contains("create_time")) {
+                return login;
+            }
+            return login + " " + strings.at("create_time");
+        }
+    };
+
+    struct ReportTable {
+        std::vector<Row>              rows;
+        std::map<std::string, double> totals;
+    };
+
+    struct Request {
+        std::string mask;
+        time_t      from = 0;
+        time_t      to   = 0;
+        std::string snapshot;
+        std::string currency;
+        std::string rate_policy;
+        std::string order_by;
+        bool        is_ascending = false;
+
+        [[nodiscard]] std::string Json(const std::string& extra) const {
+            std::string mask_text;
+            for (const char c : mask) {
+                mask_text += c == '\\' ? "\\\\" : std::string(1, c);
+            }
+            return R"({"group":")" + mask_text + R"(","from":)" + std::to_string(from) +
+                   R"(,"to":)" + std::to_string(to) + R"(,"snapshot":")" + snapshot +
+                   R"(","currency":")" + currency + R"(","rate_policy":")" + rate_policy +
+                   R"(","order_by":")" + order_by + R"(","order":")" +
+                   (is_ascending ? "asc" : "desc") + "\"" + extra + "}";
+        }
+    };
+
+    // Expected table from the records, the snapshot and conversion rules of the request
+    ReportTable Reference(const tests::FakeServer& server, const Request& request) {
+        std::map<int, std::vector<const EquityRecord*>> by_login;
+        for (const auto& record : server.equities) {
+            if (record.create_time >= request.from && record.create_time <= request.to &&
+                tests::MatchesGroupMask(request.mask, record.group)) {
+                by_login[record.login].push_back(&record);
+            }
+        }
+
+        ReportTable table;
+        for (const auto& field : money_columns) {
+            table.totals[field] = 0.0;
+        }
+
+        for (auto& [login, records] : by_login) {
+            std::sort(records.begin(), records.end(), [](const auto* left, const auto* right) {
+                return left->create_time < right->create_time;
+            });
+            if (request.snapshot == "latest") {
+                records = {records.back()};
+            } else if (request.snapshot == "first") {
+                records = {records.front()};
+            }
+
+            for (const EquityRecord* record : records) {
+                double     multiplier  = 1.0;
+                bool       is_resolved = record->currency == request.currency;
+                const auto from        = server.rates.find(record->currency);
+                const auto to          = server.rates.find(request.currency);
+                if (!is_resolved && from != server.rates.end() && to != server.rates.end()) {
+                    multiplier  = from->second / to->second;
+                    is_resolved = true;
+                }
+                if (!is_resolved && request.rate_policy == "skip") {
+                    continue;
+                }
+
+                Row row;
+                row.numbers["login"]        = record->login;
+                row.numbers["margin_level"] = Truncate(record->margin_level);
+                row.strings["create_time"]  = FormatTime(record->create_time);
+                row.strings["group"]        = record->group;
+                row.strings["currency"]     = is_resolved ? request.currency : record->currency;
+                for (size_t column = 0; column < money_columns.size(); ++column) {
+                    const double value                 = MoneyValue(*record, column);
+                    row.numbers[money_columns[column]] = Truncate(value * multiplier);
+                    if (is_resolved) {
+                        table.totals[money_columns[column]] += value * multiplier;
+                    }
+                }
+                table.rows.push_back(std::move(row));
+            }
+        }
+
+        for (auto& [field, total] : table.totals) {
+            total = Truncate(total);
+        }
+        return table;
+    }
+
+    // Expected group totals of a rollup: every record of the range summed per group and currency
+    ReportTable RollupReference(const tests::FakeServer& server, const Request& request) {
+        std::map<std::pair<std::string, std::string>, Row> rows;
+
+        ReportTable table;
+        for (const auto& field : money_columns) {
+            table.totals[field] = 0.0;
+        }
+
+        for (const auto& record : server.equities) {
+            if (record.create_time < request.from || record.create_time > request.to ||
+                !tests::MatchesGroupMask(request.mask, record.group)) {
+                continue;
+            }
+
+            double     multiplier  = 1.0;
+            bool       is_resolved = record.currency == request.currency;
+            const auto from        = server.rates.find(record.currency);
+            const auto to          = server.rates.find(request.currency);
+            if (!is_resolved && from != server.rates.end() && to != server.rates.end()) {
+                multiplier  = from->second / to->second;
+                is_resolved = true;
+            }
+            if (!is_resolved && request.rate_policy == "skip") {
+                continue;
+            }
+
+            const std::string currency = is_resolved ? request.currency : record.currency;
+            Row&              row      = rows[{record.group, currency}];
+            row.strings["group"]       = record.group;
+            row.strings["currency"]    = currency;
+            row.numbers["records"] += 1.0;
+            for (size_t column = 0; column < money_columns.size(); ++column) {
+                const double value = MoneyValue(record, column) * multiplier;
+                row.numbers[money_columns[column]] += value;
+                if (is_resolved) {
+                    table.totals[money_columns[column]] += value;
+                }
+            }
+        }
+
+        for (auto& [key, row] : rows) {
+            for (const auto& field : money_columns) {
+                row.numbers[field] = Truncate(row.numbers[field]);
+            }
+            table.rows.push_back(std::move(row));
+        }
+        for (auto& [field, total] : table.totals) {
+            total = Truncate(total);
+        }
+        return table;
+    }
+
+    // Latest record of each login in the day holding the time, found by a plain map
+    std::map<int, const EquityRecord*> DaySnapshot(const tests::FakeServer& server,
+                                                   const std::string&       mask,
+                                                   time_t                   time) {
+        const time_t day_start = time - time % day_seconds;
+
+        std::map<int, const EquityRecord*> latest;
+        for (const auto& record : server.equities) {
+            if (record.create_time < day_start || record.create_time >= day_start + day_seconds ||
+                !tests::MatchesGroupMask(mask, record.group)) {
+                continue;
+            }
+            const EquityRecord*& kept = latest[record.login];
+            if (kept == nullptr || kept->create_time < record.create_time) {
+                kept = &record;
+            }
+        }
+        return latest;
+    }
+
+    // Expected delta table: the day snapshots of from and to joined by login through a map
+    ReportTable DeltaReference(const tests::FakeServer& server, const Request& request) {
+        const auto base    = DaySnapshot(server, request.mask, request.from);
+        const auto current = DaySnapshot(server, request.mask, request.to);
+
+        std::map<int, std::pair<const EquityRecord*, const EquityRecord*>> joined;
+        for (const auto& [login, record] : base) {
+            joined[login].first = record;
+        }
+        for (const auto& [login, record] : current) {
+            joined[login].second = record;
+        }
+
+        const auto rate = [&](const EquityRecord& record) {
+            const auto from = server.rates.find(record.currency);
+            const auto to   = server.rates.find(request.currency);
+            if (record.currency == request.currency) {
+                return std::make_pair(true, 1.0);
+            }
+            if (from != server.rates.end() && to != server.rates.end()) {
+                return std::make_pair(true, from->second / to->second);
+            }
+            return std::make_pair(false, 1.0);
+        };
+
+        ReportTable table;
+        for (const auto& field : money_columns) {
+            table.totals[field] = 0.0;
+        }
+
+        for (const auto& [login, sides] : joined) {
+            const auto [base_record, current_record] = sides;
+            const EquityRecord& source = current_record ? *current_record : *base_record;
+
+            const auto base_rate    = rate(base_record ? *base_record : source);
+            const auto current_rate = rate(source);
+            const bool is_resolved  = base_rate.first && current_rate.first;
+            if (!is_resolved && request.rate_policy == "skip") {
+                continue;
+            }
+
+            const double base_multiplier    = is_resolved ? base_rate.second : 1.0;
+            const double current_multiplier = is_resolved ? current_rate.second : 1.0;
+
+            // A missing side counts as zero; margin level is a ratio and is not converted
+            EquityRecord delta{};
+            for (const auto field : {&EquityRecord::balance,
+                                     &EquityRecord::prevbalance,
+                                     &EquityRecord::credit,
+                                     &EquityRecord::equity,
+                                     &EquityRecord::profit,
+                                     &EquityRecord::storage,
+                                     &EquityRecord::commission,
+                                     &EquityRecord::margin,
+                                     &EquityRecord::margin_free,
+                                     &EquityRecord::margin_level}) {
+                const bool   is_ratio = field == &EquityRecord::margin_level;
+                const double after =
+                    current_record ? current_record->*field * (is_ratio ? 1.0 : current_multiplier)
+                                   : 0.0;
+                const double before =
+                    base_record ? base_record->*field * (is_ratio ? 1.0 : base_multiplier) : 0.0;
+                delta.*field = after - before;
+            }
+
+            Row row;
+            row.numbers["login"]        = login;
+            row.numbers["margin_level"] = Truncate(delta.margin_level);
+            row.strings["group"]        = source.group;
+            row.strings["status"]       = !base_record ? "new" : !current_record ? "closed" : "";
+            row.strings["currency"]     = is_resolved ? request.currency : source.currency;
+            for (size_t column = 0; column < money_columns.size(); ++column) {
+                // The table has no prevbalance column, only its total
+                const double value = MoneyValue(delta, column);
+                if (money_columns[column] != std::string("prevbalance")) {
+                    row.numbers[money_columns[column]] = Truncate(value);
+                }
+                if (is_resolved) {
+                    table.totals[money_columns[column]] += value;
+                }
+            }
+            table.rows.push_back(std::move(row));
+        }
+
+        for (auto& [field, total] : table.totals) {
+            total = Truncate(total);
+        }
+        return table;
+    }
+
+    const rapidjson::Value* FindTable(const rapidjson::Value& node) {
+        if (node.IsObject()) {
+            if (node.HasMember("type") && node["type"].IsString() &&
+                std::string(node["type"].GetString()) == "Table") {
+                return &node;
+            }
+            for (const auto& member : node.GetObject()) {
+                if (const auto* table = FindTable(member.value)) {
+                    return table;
+                }
+            }
+        } else if (node.IsArray()) {
+            for (const auto& child : node.GetArray()) {
+                if (const auto* table = FindTable(child)) {
+                    return table;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void SetCell(Row& row, const std::string& column, const rapidjson::Value& value) {
+        if (value.IsNumber()) {
+            row.numbers[column] = value.GetDouble();
+        } else if (value.IsString()) {
+            row.strings[column] = value.GetString();
+        }
+    }
+
+    // Rows of a plain or compact table, expanded from the constants and dictionaries
+    bool ReadTable(const rapidjson::Value& response, ReportTable* table, std::string* error) {
+        const rapidjson::Value* node = FindTable(response);
+        if (node == nullptr) {
+            *error = "no table in the response";
+            return false;
+        }
+
+        const rapidjson::Value& props     = (*node)["props"];
+        const rapidjson::Value& data      = props["data"];
+        const rapidjson::Value& structure = data["structure"];
+        const bool              is_compact =
+            data.HasMember("encoding") && std::string(data["encoding"].GetString()) == "compact";
+
+        for (const auto& values : data["rows"].GetArray()) {
+            Row row;
+            for (rapidjson::SizeType index = 0; index < values.Size(); ++index) {
+                const std::string column = structure[index].GetString();
+                if (is_compact && data["dictionaries"].HasMember(column.c_str())) {
+                    const auto& dictionary = data["dictionaries"][column.c_str()];
+                    const auto  entry = static_cast<rapidjson::SizeType>(values[index].GetDouble());
+                    SetCell(row, column, dictionary[entry]);
+                } else {
+                    SetCell(row, column, values[index]);
+                }
+            }
+            if (is_compact) {
+                for (const auto& constant : data["constants"].GetObject()) {
+                    SetCell(row, constant.name.GetString(), constant.value);
+                }
+            }
+            table->rows.push_back(std::move(row));
+        }
+
+        for (const auto& total : props["totalData"][0].GetObject()) {
+            if (total.value.IsNumber()) {
+                table->totals[total.name.GetString()] = total.value.GetDouble();
+            }
+        }
+        return true;
+    }
+
+    // Rows of a CSV export; the header holds the language tokens in schema order
+    bool ReadExport(const rapidjson::Value& response, ReportTable* table, std::string* error) {
+        if (!response.HasMember("attachment")) {
+            *error = "no attachment in the response";
+            return false;
+        }
+
+        constexpr std::array<const char*, 15> columns = {"login",
+                                                         "create_time",
+                                                         "group",
+                                                         "balance",
+                                                         "prevbalance",
+                                                         "floating_pl",
+                                                         "credit",
+                                                         "equity",
+                                                         "profit",
+                                                         "storage",
+                                                         "commission",
+                                                         "margin",
+                                                         "margin_free",
+                                                         "margin_level",
+                                                         "currency"};
+
+        std::istringstream content(response["attachment"]["content"].GetString());
+        std::string        line;
+        std::getline(content, line);
+
+        while (std::getline(content, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+
+            Row                row;
+            std::istringstream fields(line);
+            std::string        field;
+            for (size_t index = 0; std::getline(fields, field, ','); ++index) {
+                const std::string column = columns.at(index);
+                if (column == "create_time" || column == "group" || column == "currency") {
+                    row.strings[column] = field;
+                } else {
+                    row.numbers[column] = std::strtod(field.c_str(), nullptr);
+                }
+            }
+            table->rows.push_back(std::move(row));
+        }
+        return true;
+    }
+
+    bool IsClose(double expected, double actual, double tolerance) {
+        return std::fabs(expected - actual) <= tolerance + 1e-9 * std::fabs(expected);
+    }
+
+    // Same rows, cell by cell, and the same totals; rows are matched by their key
+    bool Compare(const ReportTable& expected,
+                 const ReportTable& actual,
+                 bool               has_totals,
+                 bool               is_summed,
+                 std::string*       error) {
+        if (expected.rows.size() != actual.rows.size()) {
+            *error = "expected " + std::to_string(expected.rows.size()) + " rows, got " +
+                     std::to_string(actual.rows.size());
+            return false;
+        }
+
+        std::map<std::string, const Row*> rows;
+        for (const auto& row : actual.rows) {
+            rows[row.Key()] = &row;
+        }
+
+        for (const auto& row : expected.rows) {
+            const auto it = rows.find(row.Key());
+            if (it == rows.end()) {
+                *error = "missing row " + row.Key();
+                return false;
+            }
+            for (const auto& [column, value] : row.numbers) {
+                const auto cell = it->second->numbers.find(column);
+                // CSV numbers are printed with six significant digits at least, sums in
+                // another order may truncate one cent apart
+                const double tolerance = 1e-6 * std::fabs(value) + (is_summed ? 0.011 : 1e-9);
+                if (cell == it->second->numbers.end() ||
+                    !IsClose(value, cell->second, tolerance)) {
+                    *error = "row " + row.Key() + " column " + column + " differs";
+                    return false;
+                }
+            }
+            for (const auto& [column, value] : row.strings) {
+                const auto cell = it->second->strings.find(column);
+                if (cell == it->second->strings.end() || cell->second != value) {
+                    *error = "row " + row.Key() + " column " + column + " differs";
+                    return false;
+                }
+            }
+        }
+
+        if (!has_totals) {
+            return true;
+        }
+        for (const auto& [field, value] : expected.totals) {
+            const auto total = actual.totals.find(field);
+            // Sums in another order may truncate one cent apart
+            if (total == actual.totals.end() || !IsClose(value, total->second, 0.011)) {
+                *error = "total " + field + " differs";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Rows must follow the requested column and direction
+    bool IsOrdered(const ReportTable& table, const Request& request) {
+        const auto compare = [&](const Row& left, const Row& right) {
+            const auto number = left.numbers.find(request.order_by);
+            if (number != left.numbers.end()) {
+                return number->second < right.numbers.at(request.order_by);
+            }
+            return left.strings.at(request.order_by) < right.strings.at(request.order_by);
+        };
+
+        for (size_t index = 1; index < table.rows.size(); ++index) {
+            const Row& previous = table.rows[index - 1];
+            const Row& current  = table.rows[index];
+            if (request.is_ascending ? compare(current, previous) : compare(previous, current)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T, size_t Count>
+    const T& Pick(std::mt19937& random, const std::array<T, Count>& choices) {
+        return choices[std::uniform_int_distribution<size_t>(0, Count - 1)(random)];
+    }
+
+    Request RandomRequest(std::mt19937& random) {
+        constexpr std::array<const char*, 4> masks     = {"*", "real*", "*,!demo*", "real\\a"};
+        constexpr std::array<const char*, 3> snapshots = {"all", "latest", "first"};
+        constexpr std::array<const char*, 2> targets   = {"USD", "EUR"};
+        constexpr std::array<const char*, 2> policies  = {"mark", "skip"};
+        constexpr std::array<const char*, 5> orders    = {
+            "login", "equity", "balance", "margin_level", "group"};
+
+        std::uniform_int_distribution<time_t> pick_time(book_start,
+                                                        book_start + book_days * day_seconds);
+
+        Request request;
+        request.mask         = Pick(random, masks);
+        request.from         = pick_time(random);
+        request.to           = pick_time(random);
+        request.snapshot     = Pick(random, snapshots);
+        request.currency     = Pick(random, targets);
+        request.rate_policy  = Pick(random, policies);
+        request.order_by     = Pick(random, orders);
+        request.is_ascending = std::bernoulli_distribution(0.5)(random);
+        if (request.from > request.to) {
+            std::swap(request.from, request.to);
+        }
+        return request;
+    }
+
+    struct Variant {
+        const char* name;
+        const char* extra;   // Request fields added to the random ones
+        bool        is_csv;  // Attachment instead of the table UI
+        bool        ordered; // Rows follow order_by
+    };
+
+    constexpr std::array<Variant, 4> variants = {{
+        {"table", "", false, true},
+        {"compact", R"(,"compact":true)", false, true},
+        {"bounded_memory", R"(,"bounded_memory":true)", false, false},
+        {"csv", R"(,"format":"csv")", true, true},
+    }};
+
+    constexpr size_t rollups_per_run = 6;
+
+    const std::string& RollupFile() {
+        static const std::string path =
+            (std::filesystem::temp_directory_path() / "DifferentialReportTest.cube").string();
+        return path;
+    }
+
+    /**
+     * Rollups over random, partly overlapping ranges of one book. They fill the cube in split
+     * runs, are compared with totals of the records, then asked again from the cube reloaded
+     * from its file after a restart.
+     */
+    int RollupFailures(tests::FakeServer& server, std::mt19937& random, long run) {
+        std::vector<Request> requests;
+        for (size_t index = 0; index < rollups_per_run; ++index) {
+            Request request  = RandomRequest(random);
+            request.snapshot = "all";
+            request.order_by = "group";
+            requests.push_back(std::move(request));
+        }
+
+        int failures = 0;
+        for (const char* pass : {"rollup", "reloaded rollup"}) {
+            for (const auto& request : requests) {
+                const std::string   json = request.Json(R"(,"rollup":true)");
+                rapidjson::Document query;
+                query.Parse(json.c_str());
+
+                rapidjson::Document response;
+                response.SetObject();
+                CreateReport(query, response, response.GetAllocator(), &server);
+
+                ReportTable actual;
+                std::string error;
+                if (ReadTable(response, &actual, &error)) {
+                    Compare(RollupReference(server, request), actual, true, true, &error);
+                }
+
+                if (!error.empty()) {
+                    std::cerr << "run " << run << " " << pass << ": " << error << "\n  " << json
+                              << std::endl;
+                    ++failures;
+                }
+            }
+            DestroyReport();
+        }
+
+        std::filesystem::remove(RollupFile());
+        return failures;
+    }
+
+    /**
+     * Delta reports between two different days of a book where some logins are dropped from
+     * one of the days, so the merge-join meets logins present on one side only. Plain and
+     * compact tables are compared with the map join of DeltaReference.
+     */
+    int DeltaFailures(tests::FakeServer server, std::mt19937& random, long run) {
+        std::uniform_int_distribution<time_t> pick_day(0, book_days - 1);
+        std::uniform_int_distribution<time_t> pick_offset(0, day_seconds - 1);
+
+        Request request = RandomRequest(random);
+        time_t  base_day    = pick_day(random);
+        time_t  current_day = pick_day(random);
+        while (current_day == base_day) {
+            current_day = pick_day(random);
+        }
+        if (base_day > current_day) {
+            std::swap(base_day, current_day);
+        }
+        request.from = book_start + base_day * day_seconds + pick_offset(random);
+        request.to   = book_start + current_day * day_seconds + pick_offset(random);
+
+        // Logins closed after the base day or opened before the current one
+        std::bernoulli_distribution is_dropped(0.15);
+        std::map<int, time_t>       dropped_day;
+        for (const auto& record : server.equities) {
+            if (!dropped_day.contains(record.login) && is_dropped(random)) {
+                dropped_day[record.login] =
+                    std::bernoulli_distribution(0.5)(random) ? base_day : current_day;
+            }
+        }
+        std::erase_if(server.equities, [&](const EquityRecord& record) {
+            const auto dropped = dropped_day.find(record.login);
+            return dropped != dropped_day.end() &&
+                   (record.create_time - book_start) / day_seconds == dropped->second;
+        });
+
+        const ReportTable expected = DeltaReference(server, request);
+
+        int failures = 0;
+        for (const char* extra : {R"(,"mode":"delta")", R"(,"mode":"delta","compact":true)"}) {
+            const std::string   json = request.Json(extra);
+            rapidjson::Document query;
+            query.Parse(json.c_str());
+
+            rapidjson::Document response;
+            response.SetObject();
+            CreateReport(query, response, response.GetAllocator(), &server);
+
+            ReportTable actual;
+            std::string error;
+            if (ReadTable(response, &actual, &error) &&
+                Compare(expected, actual, true, false, &error) && !IsOrdered(actual, request)) {
+                error = "rows do not follow " + request.order_by;
+            }
+
+            if (!error.empty()) {
+                std::cerr << "run " << run << " delta: " << error << "\n  " << json << std::endl;
+                ++failures;
+            }
+        }
+        return failures;
+    }
+
+    // Sorted row keys of the table in the response, empty when there is none
+    std::vector<std::string> TableKeys(tests::FakeServer& server, const std::string& json) {
+        rapidjson::Document query;
+        query.Parse(json.c_str());
+
+        rapidjson::Document response;
+        response.SetObject();
+        CreateReport(query, response, response.GetAllocator(), &server);
+
+        ReportTable              table;
+        std::string              error;
+        std::vector<std::string> keys;
+        if (ReadTable(response, &table, &error)) {
+            for (const auto& row : table.rows) {
+                keys.push_back(row.Key());
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    /**
+     * A value the row spill cannot write makes bounded_memory fall back to the in-memory build,
+     * which must still list every row of the plain table.
+     */
+    int SpillFallbackFailures(tests::FakeServer server, std::mt19937& random, long run) {
+        if (server.equities.empty()) {
+            return 0;
+        }
+        std::uniform_int_distribution<size_t> pick(0, server.equities.size() - 1);
+        server.equities[pick(random)].equity = std::numeric_limits<double>::infinity();
+
+        Request request  = RandomRequest(random);
+        request.snapshot = "all";
+
+        const auto plain   = TableKeys(server, request.Json(""));
+        const auto bounded = TableKeys(server, request.Json(R"(,"bounded_memory":true)"));
+        if (plain == bounded) {
+            return 0;
+        }
+
+        std::cerr << "run " << run << " spill fallback: " << bounded.size() << " rows instead of "
+                  << plain.size() << "\n  " << request.Json(R"(,"bounded_memory":true)")
+                  << std::endl;
+        return 1;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const long runs = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 40;
+
+    // Read when the plugin runtime is created, so the cube of every run is saved and reloaded
+    setenv("DAILY_EQUITY_ROLLUP_FILE", RollupFile().c_str(), 1);
+
+    int failures = 0;
+    for (long run = 1; run <= runs; ++run) {
+        std::mt19937 random(static_cast<std::mt19937::result_type>(run));
+
+        tests::FakeServer server;
+        tests::FillRandomBook(
+            server, random, book_start, book_days, 20 + static_cast<size_t>(random() % 200));
+
+        const Request     request  = RandomRequest(random);
+        const ReportTable expected = Reference(server, request);
+
+        for (const auto& variant : variants) {
+            const std::string   json = request.Json(variant.extra);
+            rapidjson::Document query;
+            query.Parse(json.c_str());
+
+            rapidjson::Document response;
+            response.SetObject();
+            CreateReport(query, response, response.GetAllocator(), &server);
+
+            ReportTable actual;
+            std::string error;
+            const bool  is_read = variant.is_csv ? ReadExport(response, &actual, &error)
+                                                 : ReadTable(response, &actual, &error);
+
+            if (is_read && Compare(expected, actual, !variant.is_csv, false, &error) &&
+                variant.ordered && !IsOrdered(actual, request)) {
+                error = "rows do not follow " + request.order_by;
+            }
+
+            if (!error.empty()) {
+                std::cerr << "run " << run << " " << variant.name << ": " << error << "\n  "
+                          << json << std::endl;
+                ++failures;
+            }
+        }
+
+        failures += RollupFailures(server, random, run);
+        failures += SpillFallbackFailures(server, random, run);
+        failures += DeltaFailures(server, random, run);
+    }
+
+    DestroyReport();
+    std::cout << runs << " runs, " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include "FakeServer.h"
+
+#include <array>
+#include <cmath>
+#include <string_view>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace tests {
+    namespace {
+        constexpr time_t day_seconds = 86400;
+
+        bool MatchesPattern(std::string_view pattern, std::string_view group) {
+            if (pattern.empty()) {
+                return group.empty();
+            }
+            if (pattern.front() == '*') {
+                for (size_t skip = 0; skip <= group.size(); ++skip) {
+                    if (MatchesPattern(pattern.substr(1), group.substr(skip))) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            return !group.empty() && pattern.front() == group.front() &&
+                   MatchesPattern(pattern.substr(1), group.substr(1));
+        }
+
+        double Cents(std::mt19937& random, double low, double high) {
+            std::uniform_real_distribution<double> distribution(low, high);
+            return std::round(distribution(random) * 100.0) / 100.0;
+        }
+    } // namespace
+
+    bool MatchesGroupMask(std::string_view mask, std::string_view group) {
+        bool is_included = false;
+        while (true) {
+            const size_t           comma   = mask.find(',');
+            const std::string_view pattern = mask.substr(0, comma);
+
+            if (!pattern.empty() && pattern.front() == '!') {
+                if (MatchesPattern(pattern.substr(1), group)) {
+                    return false;
+                }
+            } else if (MatchesPattern(pattern, group)) {
+                is_included = true;
+            }
+
+            if (comma == std::string_view::npos) {
+                return is_included;
+            }
+            mask.remove_prefix(comma + 1);
+        }
+    }
+
+    int FakeServer::LogsOut(const std::string& /*type*/, const std::string& /*message*/) {
+        return RET_OK;
+    }
+
+    int FakeServer::GetAccountsEquitiesByGroup(time_t                     from,
+                                               time_t                     to,
+                                               const std::string&         group_filter,
+                                               std::vector<EquityRecord>* records) {
+        if (is_equity_fetch_failing) {
+            return RET_ERROR;
+        }
+        for (const auto& record : equities) {
+            if (record.create_time >= from && record.create_time <= to &&
+                MatchesGroupMask(group_filter, record.group)) {
+                records->push_back(record);
+            }
+        }
+        return RET_OK;
+    }
+
+    int FakeServer::GetAllGroups(std::vector<GroupRecord>* records) {
+        records->insert(records->end(), groups.begin(), groups.end());
+        return RET_OK;
+    }
+
+    int FakeServer::CalculateConvertRateByCurrency(const std::string& from_currency,
+                                                   const std::string& to_currency,
+                                                   int /*cmd*/,
+                                                   double* multiplier) {
+        const auto from = rates.find(from_currency);
+        const auto to   = rates.find(to_currency);
+        if (from == rates.end() || to == rates.end()) {
+            return RET_ERROR;
+        }
+
+        *multiplier = from->second / to->second;
+        return RET_OK;
+    }
+
+    int FakeServer::SendToManager(int /*manager_id*/, const Value& data) {
+        states.push_back(Serialize(data));
+        return RET_OK;
+    }
+
+    int FakeServer::SendState(const Value& data) {
+        states.push_back(Serialize(data));
+        return RET_OK;
+    }
+
+    void FillRandomBook(FakeServer&   server,
+                        std::mt19937& random,
+                        time_t        from,
+                        size_t        days,
+                        size_t        logins) {
+        // JPY has no rate, so its rows stay unconverted
+        constexpr std::array<const char*, 4> currencies = {"USD", "EUR", "GBP", "JPY"};
+        constexpr std::array<const char*, 3> groups     = {"real\\a", "real\\b", "demo\\c"};
+
+        server.rates = {{"USD", 1.0}, {"EUR", 1.08}, {"GBP", 1.27}};
+
+        for (const char* name : groups) {
+            GroupRecord group;
+            group.group    = name;
+            group.currency = "USD";
+            server.groups.push_back(group);
+        }
+
+        std::uniform_int_distribution<size_t> pick_group(0, groups.size() - 1);
+        std::uniform_int_distribution<size_t> pick_currency(0, currencies.size() - 1);
+        std::bernoulli_distribution           is_missing(0.2);
+
+        for (size_t index = 0; index < logins; ++index) {
+            const int         login    = 10000 + static_cast<int>(index) * 7;
+            const std::string group    = groups[pick_group(random)];
+            const std::string currency = currencies[pick_currency(random)];
+
+            for (size_t day = 0; day < days; ++day) {
+                if (is_missing(random)) {
+                    continue;
+                }
+
+                EquityRecord record;
+                record.login       = login;
+                record.group       = group;
+                record.currency    = currency;
+                record.create_time = from + static_cast<time_t>(day) * day_seconds + 79200;
+                record.balance     = Cents(random, 0.0, 50000.0);
+                record.prevbalance = Cents(random, 0.0, 50000.0);
+                record.equity      = record.balance + Cents(random, -2000.0, 2000.0);
+                record.credit      = Cents(random, 0.0, 500.0);
+                record.profit      = Cents(random, -1000.0, 1000.0);
+                record.storage     = Cents(random, -50.0, 50.0);
+                record.commission  = Cents(random, -20.0, 0.0);
+                record.margin      = Cents(random, 0.0, 10000.0);
+                record.margin_free = record.equity - record.margin;
+                record.margin_level =
+                    record.margin > 0.0 ? record.equity / record.margin * 100.0 : 0.0;
+                server.equities.push_back(record);
+            }
+        }
+    }
+
+    std::string Serialize(const rapidjson::Value& value) {
+        rapidjson::StringBuffer                    buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        value.Accept(writer);
+        return {buffer.GetString(), buffer.GetSize()};
+    }
+} // namespace tests
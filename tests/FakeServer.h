@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Structures.h"
+
+namespace tests {
+    /**
+     * In-memory server for the offline tests.
+     *
+     * Serves the given equity records, groups and conversion rates the way the trade server
+     * does: equities are filtered by the requested time range and group mask, a currency
+     * without a rate fails its conversion. Every other call fails with RET_ERROR.
+     * Equity fetches fail too while is_equity_fetch_failing is set.
+     */
+    class FakeServer : public CServerInterface {
+    public:
+        std::vector<EquityRecord>     equities;
+        std::vector<GroupRecord>      groups;
+        std::map<std::string, double> rates; // Multiplier of each currency to USD
+        std::vector<std::string>      states; // Serialized SendState/SendToManager payloads
+        bool                          is_equity_fetch_failing = false;
+
+        int LogsOut(const std::string& type, const std::string& message) override;
+
+        int GetAccountsEquitiesByGroup(time_t                     from,
+                                       time_t                     to,
+                                       const std::string&         group_filter,
+                                       std::vector<EquityRecord>* records) override;
+
+        int GetAllGroups(std::vector<GroupRecord>* records) override;
+
+        int CalculateConvertRateByCurrency(const std::string& from_currency,
+                                           const std::string& to_currency,
+                                           int                cmd,
+                                           double*            multiplier) override;
+
+        int SendToManager(int manager_id, const Value& data) override;
+        int SendState(const Value& data) override;
+    };
+
+    // Group mask in the server syntax: comma-separated patterns with '*', '!' excluding one
+    bool MatchesGroupMask(std::string_view mask, std::string_view group);
+
+    // Groups, rates and closed-day records of `logins` accounts over `days` days from `from`
+    void FillRandomBook(FakeServer&   server,
+                        std::mt19937& random,
+                        time_t        from,
+                        size_t        days,
+                        size_t        logins);
+
+    // Compact JSON text of a value
+    std::string Serialize(const rapidjson::Value& value);
+} // namespace tests
@@ -0,0 +1,39 @@
+// Runs the fuzz entry point over corpus files without libFuzzer, for compilers that lack it
+// and for replaying the checked-in corpus as a test. Usage: <binary> <file or directory>...
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+    void Replay(const std::filesystem::path& path) {
+        std::ifstream     file(path, std::ios::binary);
+        const std::string input((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t inputs = 0;
+    for (int index = 1; index < argc; ++index) {
+        const std::filesystem::path path = argv[index];
+        if (!std::filesystem::is_directory(path)) {
+            Replay(path);
+            ++inputs;
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            Replay(entry.path());
+            ++inputs;
+        }
+    }
+
+    std::cout << inputs << " inputs replayed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,60 @@
+// libFuzzer entry point of the request parser: any JSON document must either be rejected with
+// a message or yield options inside the server limits.
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include <rapidjson/document.h>
+
+#include "utils/ReportOptionsParser.h"
+#include "utils/Utils.h"
+
+namespace {
+    void Check(bool condition) {
+        if (!condition) {
+            std::abort();
+        }
+    }
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    rapidjson::Document request;
+    request.Parse(reinterpret_cast<const char*>(data), size);
+    if (request.HasParseError()) {
+        return 0;
+    }
+
+    // Taken before parsing, so the parser's own clock is never behind it
+    const time_t parse_time = std::time(nullptr);
+
+    ReportOptions options;
+    std::string   error;
+    if (!utils::ParseReportOptions(request, &options, &error)) {
+        Check(!error.empty());
+        return 0;
+    }
+
+    const utils::RequestLimits& limits = utils::GetRequestLimits();
+    const time_t                max_span =
+        options.mode == ReportMode::History ? limits.max_history_span : limits.max_span;
+
+    Check(options.from >= 0 && options.from <= options.to);
+    Check(options.to - options.from < max_span);
+    Check(options.row_limit > 0 && options.row_limit <= limits.max_rows);
+    Check(options.currency.size() == 3);
+    Check(options.mode != ReportMode::History || options.login != 0);
+    Check(options.mode != ReportMode::Delta ||
+          (utils::DayStart(options.from) != utils::DayStart(options.to) &&
+           options.export_format == ExportFormat::None && !options.is_refresh &&
+           !options.bounded_memory));
+    Check(!options.is_refresh || (options.export_format == ExportFormat::None &&
+                                  !options.bounded_memory && !options.compact_rows));
+    Check(!options.exposure || options.to >= utils::DayStart(parse_time));
+
+    for (const auto& range : options.batch) {
+        Check(range.from <= range.to && range.to - range.from < limits.max_span);
+    }
+    return 0;
+}
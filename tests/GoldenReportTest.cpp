@@ -0,0 +1,123 @@
+// Serializes fixed reports and compares them byte for byte with the files in tests/golden.
+// Run with --update to rewrite the golden files after an intended change of the output.
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "FakeServer.h"
+#include "PluginInterface.h"
+
+namespace {
+    struct GoldenCase {
+        const char* name;
+        const char* request;
+        bool        is_fetch_failing = false;
+    };
+
+    // 2023.11.14 00:00 to 2023.11.16 23:59:59 UTC
+    constexpr std::array<GoldenCase, 9> golden_cases = {{
+        {"equity_table", R"({"group":"*","from":1699920000,"to":1700179199})"},
+        {"compact_rows", R"({"group":"real*","from":1699920000,"to":1700179199,"compact":true})"},
+        {"latest_sorted",
+         R"({"group":"*","from":1699920000,"to":1700179199,"snapshot":"latest",)"
+         R"("order_by":"equity","order":"asc"})"},
+        {"csv_export", R"({"group":"*","from":1699920000,"to":1700179199,"format":"csv"})"},
+        {"rejected", R"({"group":"*","from":1700179199,"to":1699920000})"},
+        {"rejected_delta_export",
+         R"({"group":"*","from":1699920000,"to":1700179199,"mode":"delta","format":"csv"})"},
+        {"rejected_refresh_compact",
+         R"({"group":"*","from":1699920000,"to":1700179199,"refresh":0,"compact":true})"},
+        {"rejected_past_exposure",
+         R"({"group":"*","from":1699920000,"to":1700179199,"exposure":true})"},
+        {"failed_fetch", R"({"group":"*","from":1699920000,"to":1700179199})", true},
+    }};
+
+    // Six accounts over three days in USD, EUR and JPY, the last without a rate
+    void FillBook(tests::FakeServer& server) {
+        server.rates = {{"USD", 1.0}, {"EUR", 1.1}};
+
+        for (const char* name : {"demo\\a", "real\\b"}) {
+            GroupRecord group;
+            group.group    = name;
+            group.currency = "USD";
+            server.groups.push_back(group);
+        }
+
+        for (int day = 0; day < 3; ++day) {
+            for (int index = 0; index < 6; ++index) {
+                EquityRecord record;
+                record.login        = 1000 + index;
+                record.group        = index % 2 != 0 ? "demo\\a" : "real\\b";
+                record.currency     = index == 5 ? "JPY" : (index % 3 == 0 ? "EUR" : "USD");
+                record.create_time  = 1699920000 + day * 86400 + 79200;
+                record.balance      = 100.5 * index + day;
+                record.prevbalance  = 100.5 * index;
+                record.equity       = 110.25 * index + 2 * day;
+                record.credit       = 10.0 * (index % 2);
+                record.profit       = 3.3 * index - day;
+                record.margin       = 25.0 * index;
+                record.margin_free  = record.equity - record.margin;
+                record.margin_level = record.margin > 0.0 ? record.equity / record.margin * 100 : 0;
+                server.equities.push_back(record);
+            }
+        }
+    }
+
+    std::string ReadFile(const std::string& path) {
+        std::ifstream      file(path, std::ios::binary);
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: GoldenReportTest <golden directory> [--update]" << std::endl;
+        return 2;
+    }
+
+    const std::string directory = argv[1];
+    const bool        is_update = argc > 2 && std::strcmp(argv[2], "--update") == 0;
+
+    tests::FakeServer server;
+    FillBook(server);
+
+    int failures = 0;
+    for (const auto& golden : golden_cases) {
+        rapidjson::Document request;
+        request.Parse(golden.request);
+
+        rapidjson::Document response;
+        response.SetObject();
+        server.is_equity_fetch_failing = golden.is_fetch_failing;
+        CreateReport(request, response, response.GetAllocator(), &server);
+
+        const std::string output = tests::Serialize(response) + "\n";
+        const std::string path   = directory + "/" + golden.name + ".json";
+
+        if (is_update) {
+            std::ofstream(path, std::ios::binary) << output;
+            continue;
+        }
+
+        const std::string expected = ReadFile(path);
+        if (output != expected) {
+            size_t offset = 0;
+            while (offset < output.size() && offset < expected.size() &&
+                   output[offset] == expected[offset]) {
+                ++offset;
+            }
+            std::cerr << golden.name << ": output differs from " << path << " at byte " << offset
+                      << std::endl;
+            ++failures;
+        }
+    }
+
+    DestroyReport();
+    return failures == 0 ? 0 : 1;
+}
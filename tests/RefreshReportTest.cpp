@@ -0,0 +1,138 @@
+// Polls refresh replies over a changing book and checks the inserted, updated and removed rows
+// against the changes made, for one client and for clients holding different versions.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+
+#include "FakeServer.h"
+#include "PluginInterface.h"
+
+namespace {
+    constexpr time_t book_start = 1699920000; // 2023.11.14 00:00 UTC
+    constexpr size_t book_days  = 3;
+
+    // Login sets of one refresh reply
+    struct Refresh {
+        uint64_t      version = 0;
+        bool          is_full = false;
+        uint64_t      rows    = 0;
+        std::set<int> inserted;
+        std::set<int> updated;
+        std::set<int> removed;
+    };
+
+    std::set<int> Logins(const rapidjson::Value& rows) {
+        std::set<int> logins;
+        for (const auto& row : rows.GetArray()) {
+            logins.insert(static_cast<int>(row[0].GetDouble()));
+        }
+        return logins;
+    }
+
+    Refresh Poll(tests::FakeServer& server, uint64_t since) {
+        const std::string json = R"({"group":"*","from":1699920000,"to":1700179199,)"
+                                 R"("snapshot":"latest","refresh":)" +
+                                 std::to_string(since) + "}";
+
+        rapidjson::Document query;
+        query.Parse(json.c_str());
+
+        rapidjson::Document response;
+        response.SetObject();
+        CreateReport(query, response, response.GetAllocator(), &server);
+
+        Refresh refresh;
+        if (!response.HasMember("refresh")) {
+            return refresh;
+        }
+
+        const rapidjson::Value& payload = response["refresh"];
+        refresh.version                 = payload["version"].GetUint64();
+        refresh.is_full                 = payload["full"].GetBool();
+        refresh.rows                    = payload["rows"].GetUint64();
+        refresh.inserted                = Logins(payload["inserted"]);
+        refresh.updated                 = Logins(payload["updated"]);
+        refresh.removed                 = Logins(payload["removed"]);
+        return refresh;
+    }
+
+    std::set<int> BookLogins(const tests::FakeServer& server) {
+        std::set<int> logins;
+        for (const auto& record : server.equities) {
+            logins.insert(record.login);
+        }
+        return logins;
+    }
+
+    int failures = 0;
+
+    void Expect(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "failed: " << what << std::endl;
+            ++failures;
+        }
+    }
+} // namespace
+
+int main() {
+    std::mt19937      random(7);
+    tests::FakeServer server;
+    tests::FillRandomBook(server, random, book_start, book_days, 40);
+
+    const Refresh first = Poll(server, 0);
+    Expect(first.version != 0, "a refresh reply is returned");
+    Expect(first.is_full, "the first reply is full");
+    Expect(first.inserted == BookLogins(server), "the first reply inserts every login");
+    Expect(first.rows == first.inserted.size(), "rows counts every login");
+
+    // One login changes, one leaves the book and a new one appears
+    const std::set<int> logins  = BookLogins(server);
+    const int           changed = *logins.begin();
+    const int           closed  = *std::next(logins.begin());
+    const int           opened  = *logins.rbegin() + 1;
+
+    std::erase_if(server.equities, [&](const EquityRecord& record) {
+        return record.login == closed;
+    });
+    for (auto& record : server.equities) {
+        if (record.login == changed) {
+            record.equity += 100.0;
+        }
+    }
+    EquityRecord added = server.equities.front();
+    added.login        = opened;
+    server.equities.push_back(added);
+
+    const Refresh second = Poll(server, first.version);
+    Expect(!second.is_full, "a known version gets a diff");
+    Expect(second.inserted == std::set<int>{opened}, "the new login is inserted");
+    Expect(second.updated == std::set<int>{changed}, "the changed login is updated");
+    Expect(second.removed == std::set<int>{closed}, "the closed login is removed");
+
+    // Another client still holding the first version gets the same diff
+    const Refresh other = Poll(server, first.version);
+    Expect(!other.is_full, "an older kept version gets a diff");
+    Expect(other.inserted == second.inserted && other.updated == second.updated &&
+               other.removed == second.removed,
+           "both clients see the same changes");
+
+    const Refresh unchanged = Poll(server, second.version);
+    Expect(!unchanged.is_full && unchanged.inserted.empty() && unchanged.updated.empty() &&
+               unchanged.removed.empty(),
+           "an unchanged book gives an empty diff");
+
+    // Versions beyond the kept ones fall back to a full reply
+    for (int poll = 0; poll < 4; ++poll) {
+        Poll(server, 0);
+    }
+    const Refresh expired = Poll(server, first.version);
+    Expect(expired.is_full, "a dropped version gets a full reply");
+    Expect(expired.inserted == BookLogins(server), "a full reply inserts every login");
+
+    DestroyReport();
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// Definitions of the server interface that the trade server provides to a loaded plugin.
+// Test executables link them instead; calls the fake does not override fail with RET_ERROR.
+
+#include "Structures.h"
+
+int CServerInterface::TickSet(TickInfo&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::LogsOut(const std::string&, const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetLogs(time_t,
+                              time_t,
+                              const std::string&,
+                              const std::string&,
+                              std::vector<ServerLog>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAccountsByGroup(const std::string&, std::vector<AccountRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAccountByLogin(int, AccountRecord*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAccountBalanceByLogin(int, MarginLevel*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::AddAccount(const AccountRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::UpdateAccount(const AccountRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::DeleteAccount(int) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetMarginLevelByGroup(const std::string&, std::vector<MarginLevel>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAccountsEquitiesByGroup(time_t,
+                                                 time_t,
+                                                 const std::string&,
+                                                 std::vector<EquityRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAccountsEquitiesByLogin(time_t, time_t, int, std::vector<EquityRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::OpenTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CloseTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::UpdateOpenTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::UpdateCloseTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CheckOpenTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CheckCloseTrade(const TradeRecord&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetOpenTradesByLogin(int, std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetOpenTradesByMagic(int, std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetOpenTradeByOrder(int, TradeRecord*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetOpenTradesByGroup(const std::string&,
+                                           time_t,
+                                           time_t,
+                                           std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetCloseTradesByLogin(int, std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetCloseTradesByGroup(const std::string&,
+                                            time_t,
+                                            time_t,
+                                            std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetPendingTradesByGroup(const std::string&,
+                                              time_t,
+                                              time_t,
+                                              std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAllOpenTrades(std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::BalanceIn(int, double, const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::BalanceOut(int, double, const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CreditIn(int, double, const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CreditOut(int, double, const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetTransactionsByGroup(const std::string&,
+                                             time_t,
+                                             time_t,
+                                             std::vector<TradeRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetSymbol(const std::string&, SymbolRecord*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetGroup(const std::string&, GroupRecord*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetAllGroups(std::vector<GroupRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CalculateCommission(const TradeRecord&, double*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CalculateSwap(const TradeRecord&, double*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CalculateProfit(const TradeRecord&, double*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CalculateMargin(const TradeRecord&, double*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::CalculateConvertRateByCurrency(const std::string&,
+                                                     const std::string&,
+                                                     int,
+                                                     double*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::GetCandles(const std::string&,
+                                 const std::string&,
+                                 time_t,
+                                 time_t,
+                                 std::vector<CandleRecord>*) {
+    return RET_ERROR;
+}
+
+int CServerInterface::SetCandles(const std::string&, const std::vector<CandleRecord>&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::DeleteCandlesAll(const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::DeleteCandlesPeriod(const std::string&, time_t, time_t) {
+    return RET_ERROR;
+}
+
+int CServerInterface::ImportCandleStores(const std::vector<CandleRecord>&,
+                                         int,
+                                         const std::string&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::SendToManager(int, const Value&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::BroadcastToManagers(const Value&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::SendToAccount(int, const Value&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::BroadcastToAccounts(const Value&) {
+    return RET_ERROR;
+}
+
+int CServerInterface::SendState(const Value&) {
+    return RET_ERROR;
+}